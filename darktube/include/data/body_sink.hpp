@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+
+namespace DarkTube {
+namespace Data {
+
+    // Receives a response body chunk by chunk on the network thread instead of it
+    // being buffered in HttpResponse::body
+    class BodySink {
+    public:
+        virtual ~BodySink() = default;
+
+        // Returning false aborts the transfer (CURLE_WRITE_ERROR)
+        virtual bool write(const char* data, size_t size) = 0;
+    };
+
+} // namespace Data
+} // namespace DarkTube
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace DarkTube {
+namespace Data {
+
+    // Handed to NetworkClient calls by whoever owns the result. Once cancelled the
+    // caller's callback never runs, and the transfer itself is aborted as soon as
+    // no other caller that joined it still wants the response.
+    class CancelToken {
+    public:
+        void cancel() { cancelled = true; }
+        bool isCancelled() const { return cancelled; }
+
+    private:
+        std::atomic<bool> cancelled{false};
+    };
+
+    using CancelTokenPtr = std::shared_ptr<CancelToken>;
+
+} // namespace Data
+} // namespace DarkTube
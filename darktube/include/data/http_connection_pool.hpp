@@ -0,0 +1,46 @@
+#pragma once
+
+#include <curl/curl.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+
+namespace DarkTube {
+namespace Data {
+
+    // Keeps curl easy handles alive between requests so connections (and TLS
+    // sessions) are reused instead of being re-established for every call.
+    // All handles are attached to one CURLSH that shares DNS, TLS sessions
+    // and the connection cache.
+    class HttpConnectionPool {
+    public:
+        HttpConnectionPool();
+        ~HttpConnectionPool();
+
+        // Returns a ready-to-configure handle for the url's server
+        CURL* acquire(const std::string& url);
+        // Hands a handle back for reuse once its transfer has finished
+        void release(const std::string& url, CURL* handle);
+
+        // Drops every idle handle (e.g. when the active server changes)
+        void clear();
+
+    private:
+        static void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+        static void unlockShare(CURL* handle, curl_lock_data data, void* userptr);
+
+        static std::string serverKey(const std::string& url);
+        void prepare(CURL* handle);
+
+        CURLSH* share = nullptr;
+        std::mutex shareLocks[CURL_LOCK_DATA_LAST];
+
+        std::mutex poolMutex;
+        std::unordered_map<std::string, std::vector<CURL*>> idleHandles;
+
+        static constexpr size_t MaxIdlePerServer = 8;
+    };
+
+} // namespace Data
+} // namespace DarkTube
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <curl/curl.h>
+#include <string>
+#include <deque>
+#include <unordered_set>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "http_connection_pool.hpp"
+#include "body_sink.hpp"
+#include "request_priority.hpp"
+#include "../domain/bandwidth_estimator.hpp"
+
+namespace DarkTube {
+namespace Data {
+
+    struct HttpRequest {
+        std::string url;
+        bool headOnly = false;
+        long timeoutSec = 10;
+        // When set, the body streams into the sink and HttpResponse::body stays empty
+        std::shared_ptr<BodySink> sink;
+        // Polled by the network thread; returning true aborts the transfer (or drops
+        // it before it starts) and completes it with CURLE_ABORTED_BY_CALLBACK
+        std::function<bool()> cancelled;
+        // Re-evaluated while queued; unset means RequestPriority::Page
+        PriorityFn priority;
+    };
+
+    struct HttpResponse {
+        CURLcode code = CURLE_OK;
+        long status = 0;
+        std::string body;
+        std::shared_ptr<BodySink> sink; // HttpRequest::sink, once it has seen the whole body
+        size_t bodyBytes = 0;           // after content decoding, whether it went to body or sink
+
+        bool ok() const { return code == CURLE_OK; }
+        bool aborted() const { return code == CURLE_ABORTED_BY_CALLBACK; }
+        std::string error() const { return curl_easy_strerror(code); }
+    };
+
+    // Drives every transfer from a single network thread through curl_multi.
+    // Completions are handed to brls::async workers, so the network thread only
+    // does I/O and worker threads never block on a socket.
+    class HttpReactor {
+    public:
+        using Completion = std::function<void(HttpResponse& response)>;
+
+        // Totals since startup. wireBytes vs. bodyBytes is what compression saved,
+        // connections vs. transfers what keep-alive and multiplexing saved.
+        struct Stats {
+            size_t transfers = 0;
+            size_t http2Transfers = 0;
+            size_t connections = 0; // new connections opened (incl. TLS handshakes)
+            size_t wireBytes = 0;   // response bodies as received
+            size_t bodyBytes = 0;   // response bodies after decoding
+        };
+
+        explicit HttpReactor(HttpConnectionPool* pool);
+        ~HttpReactor();
+
+        void submit(const HttpRequest& request, Completion done);
+        // Makes the network thread re-check cancellation right away
+        void wakeup();
+
+        // Transfers beyond this cap wait in a queue until a slot frees up. Thumbnail-level
+        // transfers never take the last ReservedSlots, so Play and paging don't queue behind them.
+        void setMaxConcurrentTransfers(size_t max);
+        size_t getMaxConcurrentTransfers() const { return maxConcurrent; }
+
+        Stats getStats() const;
+
+        // Fed with every completed transfer big enough to say something about bandwidth
+        Domain::BandwidthEstimator& getBandwidth() { return bandwidth; }
+
+    private:
+        struct Transfer {
+            HttpRequest request;
+            Completion done;
+            HttpResponse response;
+            CURL* handle = nullptr;
+            bool background = false;
+        };
+
+        static constexpr size_t ReservedSlots = 2;
+
+        void run();
+        void startPending();
+        void start(Transfer* t);
+        void abortCancelled();
+        void finish(CURL* handle, CURLcode result);
+        void recordStats(CURL* handle, const HttpResponse& response);
+        static void complete(Transfer* t);
+
+        HttpConnectionPool* pool;
+        CURLM* multi = nullptr;
+        bool http2 = false; // this libcurl can negotiate h2 over TLS
+        std::thread worker;
+        std::atomic<bool> running{true};
+        std::atomic<size_t> maxConcurrent{16};
+        std::atomic<bool> rescheduleNeeded{true}; // queue or free slots changed since the last pass
+
+        std::mutex queueMutex;
+        std::deque<Transfer*> pending;
+        std::unordered_set<Transfer*> inFlight; // only touched by the network thread
+
+        std::atomic<size_t> transferCount{0};
+        std::atomic<size_t> http2Count{0};
+        std::atomic<size_t> connectionCount{0};
+        std::atomic<size_t> wireBytes{0};
+        std::atomic<size_t> bodyBytes{0};
+        Domain::BandwidthEstimator bandwidth;
+    };
+
+} // namespace Data
+} // namespace DarkTube
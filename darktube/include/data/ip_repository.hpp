@@ -3,10 +3,31 @@
 #include "../domain/models.hpp"
 #include <vector>
 #include <string>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <borealis/core/event.hpp>
 
 namespace DarkTube {
 namespace Data {
 
+    // One version of the settings. Never modified once published: a change publishes a
+    // new snapshot, and the old one stays valid for as long as the repository lives.
+    struct ConfigSnapshot {
+        uint64_t version = 0;
+        std::vector<Domain::ServerIP> servers;
+        Domain::ServerIP activeServer;
+        std::string language = "en-US";
+        bool useProxy = false;
+        bool powerSaving = true;
+        bool diskCache = false;
+        std::string baseUrl; // API root of the active server, "" when none is set
+    };
+
     class IPRepository {
     public:
         // Singleton access
@@ -15,33 +36,78 @@ namespace Data {
             return instance;
         }
 
+        // Current settings, from any thread without locking or copying. Hold on to the
+        // reference for a consistent view across several fields.
+        const ConfigSnapshot& getConfig() const { return *current.load(std::memory_order_acquire); }
+
         // Methods
         std::vector<Domain::ServerIP> getSavedServers();
         void addServer(const Domain::ServerIP& server);
         void removeServer(const std::string& id);
-        
-        bool loadFromFile();
+
+        // Queues a write of the current settings; a background thread writes them once
+        // changes stop coming for SaveDelay, and only if they differ from the file
         void saveToFile();
+        // Blocks until queued changes are on disk
+        void flush();
 
         // Currently active server
         void setActiveServer(const Domain::ServerIP& server);
         void updateServer(const Domain::ServerIP& server);
         Domain::ServerIP getActiveServer() const;
 
+        // Fired on the calling thread whenever the active server (or its address) changes
+        brls::Event<Domain::ServerIP>* getActiveServerChangedEvent() { return &activeServerChanged; }
+
         // Language support
-        std::string getLanguage() const { return m_language; }
+        std::string getLanguage() const { return getConfig().language; }
         void setLanguage(const std::string& lang);
 
         // Proxy support
-        bool getUseProxy() const { return m_useProxy; }
+        bool getUseProxy() const { return getConfig().useProxy; }
         void setUseProxy(bool useProxy);
 
+        // Drop to a low frame rate while nothing on screen changes
+        bool getPowerSaving() const { return getConfig().powerSaving; }
+        void setPowerSaving(bool powerSaving);
+
+        // Long videos buffer to a temporary file instead of RAM
+        bool getDiskCache() const { return getConfig().diskCache; }
+        void setDiskCache(bool diskCache);
+
     private:
+        static constexpr std::chrono::milliseconds SaveDelay{500};
+
         IPRepository(); // Initialize with mock data
-        std::vector<Domain::ServerIP> m_servers;
-        Domain::ServerIP m_activeServer;
-        std::string m_language = "en-US";
-        bool m_useProxy = false;
+        ~IPRepository();
+
+        // Constructor only: it sets writtenConfig, which the writer thread owns once started
+        bool loadFromFile();
+        void update(const std::function<void(ConfigSnapshot&)>& change);
+        std::string serialize() const;
+        void writerLoop();
+        void writeConfig(const std::string& config);
+
+        // Published with release order for readers. Writers (the setters) serialise on
+        // updateMutex; every snapshot published is kept in `snapshots`, so a reader's
+        // reference never dangles. Settings change a handful of times per session.
+        std::atomic<const ConfigSnapshot*> current{nullptr};
+        std::mutex updateMutex;
+        std::vector<std::unique_ptr<const ConfigSnapshot>> snapshots;
+
+        brls::Event<Domain::ServerIP> activeServerChanged;
+
+        // Background writer, fed serialized configs under saveMutex
+        std::thread writer;
+        std::mutex saveMutex;
+        std::condition_variable saveCondition;
+        std::string pendingConfig;
+        bool savePending = false;
+        bool writing = false;
+        bool flushRequested = false;
+        bool writerRunning = true;
+        std::chrono::steady_clock::time_point lastChange;
+        std::string writtenConfig; // what the file holds; writer thread only once it runs
     };
 
 } // namespace Data
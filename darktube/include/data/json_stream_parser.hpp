@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace DarkTube {
+namespace Data {
+
+    // SAX events, named after nlohmann::json_sax. Strings are handed out by
+    // reference so handlers can move them into models without a copy.
+    // Returning false from key() skips that member's whole value: no events are
+    // fired for it and none of its strings are buffered.
+    class JsonSaxHandler {
+    public:
+        virtual ~JsonSaxHandler() = default;
+
+        virtual void null() {}
+        virtual void boolean(bool value) {}
+        virtual void number(const std::string& text) {}
+        virtual void string(std::string& value) {}
+        virtual bool key(std::string& name) { return true; }
+        virtual void startObject() {}
+        virtual void endObject() {}
+        virtual void startArray() {}
+        virtual void endArray() {}
+    };
+
+    // Push parser: accepts the document in arbitrary chunks (e.g. straight from the
+    // curl write callback) and fires SAX events as soon as each token is complete.
+    class JsonStreamParser {
+    public:
+        explicit JsonStreamParser(JsonSaxHandler* handler) : handler(handler) {}
+
+        // Returns false once the input is known to be invalid
+        bool feed(const char* data, size_t size);
+        // True if exactly one complete top-level value was parsed
+        bool finish();
+
+        bool failed() const { return !error.empty(); }
+        const std::string& getError() const { return error; }
+        size_t getBytesParsed() const { return offset; }
+
+    private:
+        enum class Lex { None, String, Escape, Unicode, Number, Literal };
+        enum class Expect { Value, ValueOrEnd, Key, KeyOrEnd, Colon, CommaOrEnd, Done };
+
+        bool structural(char c);
+        bool beginValue();
+        void afterValue();
+        bool muted() const { return mutedDepth > 0 || skipNext; }
+        void emitString();
+        void emitNumber();
+        bool emitLiteral();
+        void appendCodepoint(unsigned int cp);
+        bool fail(const char* reason);
+
+        JsonSaxHandler* handler;
+        Lex lex = Lex::None;
+        Expect expect = Expect::Value;
+        std::vector<char> stack; // '{' or '['
+        std::string buffer;
+        bool stringIsKey = false;
+        bool capture = true;   // false while inside a skipped value
+        bool skipNext = false; // the next value belongs to a skipped key
+        int mutedDepth = 0;    // containers opened inside a skipped value
+        unsigned int unicode = 0;
+        int unicodeDigits = 0;
+        unsigned int highSurrogate = 0;
+        size_t offset = 0;
+        std::string error;
+    };
+
+} // namespace Data
+} // namespace DarkTube
@@ -3,7 +3,17 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
 #include "../domain/models.hpp"
+#include "http_connection_pool.hpp"
+#include "http_reactor.hpp"
+#include "stream_cache.hpp"
+#include "response_parsers.hpp"
+#include "cancel_token.hpp"
+#include "request_priority.hpp"
 #include <borealis/core/singleton.hpp>
 
 namespace DarkTube {
@@ -14,17 +24,76 @@ namespace Data {
         NetworkClient();
         ~NetworkClient();
 
-        using Callback = std::function<void(const std::vector<Domain::VideoItem>&, const std::string& nextPageToken, const std::string& error)>;
+        using Callback = std::function<void(const std::vector<Domain::VideoRef>&, const std::string& nextPageToken, const std::string& error)>;
         using StreamCallback = std::function<void(const Domain::StreamInfo& info, const std::string& error)>;
+        // Rows of a page that are already parsed while the body is still downloading.
+        // cb still receives the whole page; callers that joined an identical request only get cb.
+        using ItemsCallback = std::function<void(const std::vector<Domain::VideoRef>& videos)>;
 
-        void getTrending(Callback cb, const std::string& pageToken = "");
-        void search(const std::string& query, Callback cb, const std::string& pageToken = "");
-        void getStream(const std::string& videoId, StreamCallback cb);
-        void fetchImage(const std::string& url, std::function<void(const unsigned char* data, size_t size)> cb);
+        // Every call takes an optional CancelToken; cancel it through cancel() below
+        void getTrending(Callback cb, const std::string& pageToken = "", ItemsCallback onItems = nullptr, CancelTokenPtr token = nullptr);
+        void search(const std::string& query, Callback cb, const std::string& pageToken = "", ItemsCallback onItems = nullptr, CancelTokenPtr token = nullptr);
+        void getStream(const std::string& videoId, StreamCallback cb, CancelTokenPtr token = nullptr);
+
+        // Resolve a stream ahead of time (e.g. on card focus) so playback can start without waiting
+        void prefetchStream(const std::string& videoId);
+        bool getCachedStream(const std::string& videoId, Domain::StreamInfo& info);
+        // cb runs on a worker thread with the raw image bytes (empty on failure).
+        // `priority` defaults to RequestPriority::Thumbnail.
+        void fetchImage(const std::string& url, std::function<void(const std::string& data)> cb, CancelTokenPtr token = nullptr, PriorityFn priority = nullptr);
+
+        // Drops the callbacks registered with `token` and aborts transfers nobody else is waiting on
+        void cancel(const CancelTokenPtr& token);
+
+        // Warm up a keep-alive connection to the active server in the background
+        void preconnect();
+
+        // Talk to `baseUrl` instead of the configured server, without saving it.
+        // For headless tools; call before the first request.
+        void setBaseUrlOverride(const std::string& baseUrl) { baseUrlOverride = baseUrl; }
+
+        // Runs on the network thread each time a result is queued for the main thread,
+        // e.g. to wake the frame pacer. Set once at startup.
+        void setOnResult(std::function<void()> hook) { onResult = std::move(hook); }
+
+        void setMaxConcurrentTransfers(size_t max) { reactor->setMaxConcurrentTransfers(max); }
+
+        // Requests issued vs. requests that joined an identical in-flight transfer instead
+        size_t getRequestCount() const { return requestCount; }
+        size_t getCoalescedCount() const { return coalescedCount; }
+        HttpReactor::Stats getTransferStats() const { return reactor->getStats(); }
+        // Shared by every transfer and by the player, which adds mpv's own download rate
+        Domain::BandwidthEstimator& getBandwidthEstimator() { return reactor->getBandwidth(); }
+        void logStats() const;
 
     private:
-        std::string getBaseUrl();
-        std::string performGet(const std::string& url);
+        const std::string& getBaseUrl();
+        // brls::sync for results, with onResult run first
+        void post(std::function<void()> task);
+        void performGet(const std::string& url, HttpReactor::Completion done, PriorityFn priority, std::shared_ptr<BodySink> sink = nullptr, CancelTokenPtr token = nullptr);
+        void requestStream(const std::string& videoId, StreamCallback cb, CancelTokenPtr token, int priority);
+        void getFeed(const std::string& url, FeedParser::Kind kind, Callback cb, ItemsCallback onItems, CancelTokenPtr token);
+
+        std::unique_ptr<HttpConnectionPool> connectionPool;
+        std::unique_ptr<HttpReactor> reactor;
+        StreamCache streamCache;
+        std::string baseUrlOverride;
+        std::function<void()> onResult;
+
+        struct Waiter {
+            HttpReactor::Completion done;
+            CancelTokenPtr token;
+            PriorityFn priority;
+        };
+        struct InFlight {
+            std::vector<Waiter> waiters;
+        };
+
+        // Callers waiting on each URL currently being downloaded
+        std::mutex inFlightMutex;
+        std::unordered_map<std::string, std::shared_ptr<InFlight>> inFlight;
+        std::atomic<size_t> requestCount{0};
+        std::atomic<size_t> coalescedCount{0};
     };
 
 } // namespace Data
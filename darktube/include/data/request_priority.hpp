@@ -0,0 +1,21 @@
+#pragma once
+
+#include <functional>
+
+namespace DarkTube {
+namespace Data {
+
+    // Lower runs first. Queued requests are ordered by priority whenever a slot frees
+    // up, so a priority may change while the request waits (e.g. as focus moves).
+    namespace RequestPriority {
+        constexpr int Stream = 0;      // the user pressed Play
+        constexpr int Page = 10;       // next feed page
+        constexpr int Prefetch = 20;   // speculative stream resolution
+        constexpr int Thumbnail = 100; // plus the card's distance from the focused one
+    }
+
+    // Evaluated on the network thread, so it may only read atomics
+    using PriorityFn = std::function<int()>;
+
+} // namespace Data
+} // namespace DarkTube
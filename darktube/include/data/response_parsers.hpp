@@ -0,0 +1,114 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include "../domain/models.hpp"
+#include "../domain/video_page.hpp"
+#include "body_sink.hpp"
+#include "json_stream_parser.hpp"
+
+namespace DarkTube {
+namespace Data {
+
+    // Parses a JSON body while it downloads. write() runs on the network thread,
+    // finish() on the worker that handles the completed response.
+    class JsonBodyParser : public BodySink, protected JsonSaxHandler {
+    public:
+        JsonBodyParser() : parser(this) {}
+
+        bool write(const char* data, size_t size) override { return parser.feed(data, size); }
+
+        // Validates the complete document. Safe to call again from every coalesced waiter.
+        bool finish();
+        const std::string& getError() const { return error; }
+
+    protected:
+        // Runs once after a successful parse; may set `error` for an error payload
+        virtual void complete() {}
+
+        std::string error;
+
+    private:
+        JsonStreamParser parser;
+        bool finished = false;
+    };
+
+    // /api/trending and /api/search pages, filled straight into one VideoPage
+    class FeedParser : public JsonBodyParser {
+    public:
+        enum class Kind { Trending, Search };
+        using BatchCallback = std::function<void(const std::vector<Domain::VideoRef>& videos)>;
+
+        // onBatch fires on the network thread every BatchSize parsed items
+        explicit FeedParser(Kind kind, BatchCallback onBatch = nullptr) : kind(kind), onBatch(onBatch) {}
+
+        static constexpr size_t BatchSize = 4; // one grid row
+
+        std::vector<Domain::VideoRef> videos;
+        std::string nextPageToken;
+
+    protected:
+        bool key(std::string& name) override;
+        void string(std::string& value) override;
+        void number(const std::string& text) override;
+        void startObject() override;
+        void endObject() override;
+        void startArray() override;
+        void endArray() override;
+
+    private:
+        bool inVideo() const { return path.size() >= 3 && path[0] == "videos"; }
+        void endVideo();
+
+        Kind kind;
+        BatchCallback onBatch;
+        size_t batched = 0;
+
+        std::vector<std::string> path; // current key per open container, "" inside arrays
+
+        std::shared_ptr<Domain::VideoPage> page = std::make_shared<Domain::VideoPage>();
+        Domain::VideoItem video; // scratch item, reused so its strings keep their capacity
+        std::string channelName;
+        std::string channelTitle;
+        bool hasTitle = false;
+        bool hasChannel = false;
+        bool hasChannelName = false;
+        bool hasChannelTitle = false;
+        bool hasViews = false;
+    };
+
+    // /api/stream
+    class StreamInfoParser : public JsonBodyParser {
+    public:
+        Domain::StreamInfo info;
+
+    protected:
+        bool key(std::string& name) override;
+        void string(std::string& value) override;
+        void number(const std::string& text) override;
+        void startObject() override;
+        void endObject() override;
+        void startArray() override;
+        void endArray() override;
+        void complete() override;
+
+    private:
+        // "formats" is either a flat array or grouped into audioOnly/muxed/videoOnly
+        bool inFormat() const;
+        void endFormat();
+
+        std::vector<std::string> path;
+
+        Domain::StreamFormat format;
+        size_t formatIndex = 0;
+        std::vector<Domain::StreamFormat> muxed;
+        std::vector<Domain::StreamFormat> videoOnly;
+
+        bool hasUrl = false;
+        bool hasError = false;
+        std::string serverError;
+    };
+
+} // namespace Data
+} // namespace DarkTube
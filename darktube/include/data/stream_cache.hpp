@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../domain/models.hpp"
+#include <ctime>
+#include <list>
+#include <mutex>
+#include <string>
+
+namespace DarkTube {
+namespace Data {
+
+    // Small LRU of resolved streams. Entries die before the signed URLs inside them
+    // do (their `expire=` query parameter), so a cached StreamInfo is always playable.
+    class StreamCache {
+    public:
+        explicit StreamCache(size_t capacity = 16) : capacity(capacity) {}
+
+        bool get(const std::string& videoId, Domain::StreamInfo& info);
+        void put(const std::string& videoId, const Domain::StreamInfo& info);
+        bool contains(const std::string& videoId);
+
+        // Earliest `expire=` among the stream's URLs, or now + DefaultTtl if none carry one
+        static time_t expiryOf(const Domain::StreamInfo& info);
+
+    private:
+        struct Entry {
+            std::string videoId;
+            Domain::StreamInfo info;
+            time_t expiresAt;
+        };
+
+        static constexpr time_t DefaultTtl = 5 * 60;
+        static constexpr time_t ExpiryMargin = 60; // Leave time to actually start playback
+
+        std::list<Entry>::iterator find(const std::string& videoId, time_t now);
+
+        size_t capacity;
+        std::mutex mutex;
+        std::list<Entry> entries; // front = most recently used
+    };
+
+} // namespace Data
+} // namespace DarkTube
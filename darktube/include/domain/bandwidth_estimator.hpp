@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+
+namespace DarkTube {
+namespace Domain {
+
+    // Download throughput from timed samples. Two exponentially weighted averages with
+    // different half-lives (in seconds of sampled download time) run side by side and
+    // the lower one wins, so the estimate drops quickly and recovers cautiously.
+    // Thread-safe: the network thread and the player both feed it.
+    class BandwidthEstimator {
+    public:
+        // HTTP transfers smaller than this mostly measure latency, not bandwidth
+        static constexpr double MinSampleBytes = 8 * 1024;
+        // No estimate until this much has been measured
+        static constexpr double MinTotalBytes = 128 * 1024;
+
+        // `bytes` arrived over `seconds`
+        void addSample(double bytes, double seconds);
+
+        // kbit/s, or 0 while there isn't enough data
+        double getEstimateKbps() const;
+
+    private:
+        struct Average {
+            double halfLife;
+            double estimate = 0;
+            double totalWeight = 0;
+
+            void add(double weight, double value);
+            double get() const;
+        };
+
+        mutable std::mutex mutex;
+        Average fast{2};
+        Average slow{5};
+        double totalBytes = 0;
+    };
+
+} // namespace Domain
+} // namespace DarkTube
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace DarkTube {
+namespace Domain {
+
+    // How much of a video mpv's demuxer keeps around, and where. Chosen per video from
+    // the memory left to the process, the stream's bitrate and the video's length.
+    struct CacheProfile {
+        static constexpr uint64_t MiB = 1024 * 1024;
+
+        std::string name = "default";
+        uint64_t maxBytes = 12 * MiB;    // read-ahead (demuxer-max-bytes)
+        uint64_t maxBackBytes = 5 * MiB; // kept behind the position for backward seeks
+        bool onDisk = false;             // packets go to a temporary file instead of RAM
+
+        // Any of availableBytes, kbps or durationSec may be 0 when unknown; with no
+        // memory figure the default profile is kept. diskCache allows the disk-backed
+        // profile for long videos.
+        static CacheProfile choose(uint64_t availableBytes, double kbps, double durationSec, bool diskCache);
+    };
+
+} // namespace Domain
+} // namespace DarkTube
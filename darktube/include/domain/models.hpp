@@ -31,6 +31,7 @@ namespace Domain {
         std::string proxyUrl;
         std::string quality;
         std::string type;
+        double bitrateKbps = 0; // total bitrate ("tbr"), 0 if the server didn't say
     };
 
     struct StreamInfo {
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+#include "video_page.hpp"
+
+namespace DarkTube {
+namespace Domain {
+
+    // Videos to autoplay one after another: the feed or search results a video was
+    // started from, and where in them playback is. Holds VideoRefs, so the pages stay
+    // alive but no strings are copied.
+    class PlayQueue {
+    public:
+        PlayQueue() = default;
+        PlayQueue(std::vector<VideoRef> videos, size_t current) : videos(std::move(videos)), current(current) {}
+
+        bool hasNext() const { return current + 1 < videos.size(); }
+        const VideoRef& next() const { return videos[current + 1]; }
+        void advance() {
+            if (hasNext()) current++;
+        }
+
+    private:
+        std::vector<VideoRef> videos;
+        size_t current = 0;
+    };
+
+} // namespace Domain
+} // namespace DarkTube
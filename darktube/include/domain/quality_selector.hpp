@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include "models.hpp"
+
+namespace DarkTube {
+namespace Domain {
+
+    // Chooses among a stream's formats from the bandwidth estimate and buffer health.
+    // The formats are ranked into a ladder by bitrate; rungs are positions in it.
+    // Holds no timing state: the caller decides how often to ask.
+    class QualitySelector {
+    public:
+        static constexpr double Headroom = 0.75;      // share of the estimate a format may use
+        static constexpr double LowBufferSec = 5;     // below this, drop if the format doesn't fit
+        static constexpr double HighBufferSec = 20;   // above this, try one rung up
+        static constexpr double AudioKbps = 128;      // added to video-only formats for the separate audio
+
+        QualitySelector() = default;
+        // Formats taller than maxHeight (when known) are left out of the ladder
+        QualitySelector(const std::vector<StreamFormat>& formats, int maxHeight);
+
+        bool empty() const { return ladder.empty(); }
+        size_t size() const { return ladder.size(); }
+        // Index into the formats the selector was built from
+        size_t formatAt(size_t rung) const { return ladder[rung].format; }
+        double kbpsAt(size_t rung) const { return ladder[rung].kbps; }
+        // Rung of the format at `format`, or -1 if it isn't on the ladder
+        int rungOf(size_t format) const;
+
+        // Highest rung that fits `kbps`, or the lowest when none does
+        size_t pickForBandwidth(double kbps) const;
+
+        // Rung to play next: `current` to stay, lower when the buffer runs dry on a
+        // format the bandwidth can't sustain, one higher when the buffer is healthy
+        // and the next rung fits
+        size_t next(size_t current, double kbps, double bufferSec, bool rebuffering) const;
+
+        // Height in pixels from "1280x720" or "720p", 0 if neither
+        static int heightOf(const StreamFormat& format);
+
+    private:
+        struct Rung {
+            size_t format;
+            double kbps;
+        };
+
+        std::vector<Rung> ladder;
+    };
+
+} // namespace Domain
+} // namespace DarkTube
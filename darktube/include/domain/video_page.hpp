@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <unordered_set>
+#include "models.hpp"
+
+namespace DarkTube {
+namespace Domain {
+
+    // One video of a VideoPage. Every field views into the page's arena.
+    struct VideoEntry {
+        std::string_view id;
+        std::string_view title;
+        std::string_view author; // interned: cards of the same channel share one copy
+        std::string_view thumbnailUrlMedium;
+        std::string_view views;
+        std::string_view date;
+    };
+
+    // Storage for one fetched page: the strings and entries of all its videos live in
+    // a few large blocks instead of ~6 heap strings per video. Blocks never move, so
+    // entries handed out early stay valid while the parser keeps appending to the page
+    // (only the parser thread may call add()).
+    class VideoPage {
+    public:
+        VideoPage() = default;
+        VideoPage(const VideoPage&) = delete;
+        VideoPage& operator=(const VideoPage&) = delete;
+
+        // Copies `video` into the arena
+        const VideoEntry* add(const VideoItem& video);
+
+        size_t getArenaBytes() const { return arenaBytes; }
+
+    private:
+        static constexpr size_t BlockSize = 8 * 1024;
+
+        void* allocate(size_t size, size_t align);
+        std::string_view store(const std::string& value);
+        std::string_view intern(const std::string& value);
+
+        std::vector<std::unique_ptr<char[]>> blocks;
+        size_t used = BlockSize; // bytes taken in blocks.back()
+        size_t arenaBytes = 0;
+        std::unordered_set<std::string_view> authors;
+    };
+
+    // Cheap handle to one video: copying it bumps the page's refcount instead of
+    // copying strings, and keeps the page alive for as long as a card shows it
+    class VideoRef {
+    public:
+        VideoRef() = default;
+        VideoRef(std::shared_ptr<const VideoPage> page, const VideoEntry* entry) : page(std::move(page)), entry(entry) {}
+
+        const VideoEntry* operator->() const { return entry; }
+        const VideoEntry& operator*() const { return *entry; }
+        explicit operator bool() const { return entry != nullptr; }
+
+    private:
+        std::shared_ptr<const VideoPage> page;
+        const VideoEntry* entry = nullptr;
+    };
+
+} // namespace Domain
+} // namespace DarkTube
@@ -1,7 +1,10 @@
 #pragma once
 
 #include <borealis.hpp>
+#include <borealis/views/recycler.hpp>
 #include "../domain/models.hpp"
+#include "../domain/video_page.hpp"
+#include "../data/cancel_token.hpp"
 #include <vector>
 #include <memory>
 
@@ -24,10 +27,11 @@ namespace Presentation {
         // Pagination state
         std::string nextPageToken;
         bool isLoadingMore = false;
+        Data::CancelTokenPtr feedToken; // Replaced (and cancelled) whenever the grid switches to a new feed
         std::string currentSearchQuery;
         std::string currentMode = "trending"; // "trending" or "search"
         brls::Box* gridWrapper = nullptr;
-        brls::ScrollingFrame* gridContainer = nullptr;
+        brls::RecyclerFrame* gridContainer = nullptr;
         brls::Box* loadingIndicator = nullptr;
         std::shared_ptr<bool> aliveFlag = std::make_shared<bool>(true);
 
@@ -35,16 +39,19 @@ namespace Presentation {
         brls::Box* createSidebarItem(const std::string& title, std::function<bool(brls::View*)> onClick);
         
         brls::Box* createMainContent();
-        brls::Box* createCategoryRow(const std::string& title, const std::vector<Domain::VideoItem>& videos);
+        brls::Box* createCategoryRow(const std::string& title, const std::vector<Domain::VideoRef>& videos);
         brls::Box* createEmptyStateView();
         
         void fetchTrending();
         void fetchMore();
-        void appendVideosToGrid(const std::vector<Domain::VideoItem>& videos);
-        void renderVideoGrid(const std::vector<Domain::VideoItem>& videos);
+        void restartFeed();
+        void requestPage(const std::string& pageToken);
+        void appendVideos(std::vector<Domain::VideoRef>::const_iterator first, std::vector<Domain::VideoRef>::const_iterator last);
+        void playVideo(const Domain::VideoRef& video);
+        void renderVideoGrid(const std::vector<Domain::VideoRef>& videos);
 
         std::string currentTitle = "Trending Entertainment";
-        std::vector<Domain::VideoItem> currentVideos;
+        std::vector<Domain::VideoRef> currentVideos;
         
         brls::Box* createSettingsView();
 
@@ -2,25 +2,37 @@
 
 #include <borealis.hpp>
 #include "../domain/models.hpp"
+#include "../domain/quality_selector.hpp"
+#include "../domain/play_queue.hpp"
+#include "../data/cancel_token.hpp"
+#include "view/profiled_box.hpp"
 
 namespace DarkTube {
 namespace Presentation {
 
-    class VideoPlayerView : public brls::Box {
+    class VideoPlayerView : public ProfiledBox {
     public:
         VideoPlayerView();
         void draw(NVGcontext* vg, float x, float y, float width, float height, brls::Style style, brls::FrameContext* ctx) override;
+
+    private:
+        void drawPlayerStats(NVGcontext* vg, float x, float bottom);
     };
 
     class PlayerOverlayView : public brls::Box {
     public:
-        PlayerOverlayView(const Domain::StreamInfo& info);
+        // startFormat: index into info.formats that is playing, -1 for the stream's default url
+        PlayerOverlayView(const Domain::StreamInfo& info, int startFormat, const Domain::PlayQueue& queue);
+        ~PlayerOverlayView() override;
         
         void onFocusGained() override;
         void onFocusLost() override;
         void toggleOSD(bool show);
         void frame(brls::FrameContext* ctx) override;
 
+        // Minimum time between progress bar refreshes; the labels change at most once a second anyway
+        void setProgressRefreshInterval(brls::Time ms) { progressInterval = ms; }
+
     private:
         brls::Box* topBar;
         brls::Box* bottomBar;
@@ -29,6 +41,7 @@ namespace Presentation {
         brls::Label* timeLabel;
         brls::ProgressSpinner* bufferingLoader;
         brls::Box* centerContainer;
+        brls::Label* titleLabel;
         Domain::StreamInfo streamInfo;
         bool isPlaying = true;
         bool osdVisible = false;
@@ -36,25 +49,62 @@ namespace Presentation {
         brls::Time osdLastTick = 0;
         const brls::Time osdTimeout = 3000; // 3 seconds
 
+        // What the OSD shows, so labels and the bar are only touched when that changes
+        bool osdSynced = false; // false forces a full refresh
+        uint64_t shownVersion = 0;
+        std::string shownStatus;
+        int shownSeconds = -1;
+        int shownDuration = -1;
+        float shownProgress = -1;
+        brls::Time progressLastTick = 0;
+        brls::Time progressInterval = 250;
+
+        // Adaptive quality: off once the user picks a format by hand
+        Domain::QualitySelector quality;
+        int currentRung = -1; // -1 while the playing format isn't on the ladder
+        bool autoQuality = true;
+        brls::Time qualityLastCheck = 0;
+        brls::Time qualityLastSwitch = 0;
+
+        // Autoplay: the next video is resolved near the end of this one and queued in
+        // mpv's playlist, which prefetches it and moves on by itself
+        Domain::PlayQueue queue;
+        Data::CancelTokenPtr nextToken;
+        bool nextRequested = false;
+        bool nextResolved = false;
+        bool nextQueued = false; // false: needs the separate audio track, loaded at EOF instead
+        Domain::StreamInfo nextInfo;
+        int nextFormat = -1;
+        std::string nextUrl;
+        std::string nextAudio;
+        uint64_t shownItem = 0; // MPVCore's playlistItem for the video shown
+
         brls::Box* createTopBar();
         brls::Box* createBottomBar();
         brls::Box* createProgressBar();
         brls::Box* createControlBar();
         
         void updatePlaybackInfo();
+        void updateAdaptiveQuality();
+        void switchFormat(size_t format, bool seamless);
+        void updateQueue();
+        void requestNext();
+        void advanceQueue();
         std::string formatTime(double seconds);
         void openQualitySelector();
     };
 
     class PlayerActivity : public brls::Activity {
     public:
-        PlayerActivity(const Domain::StreamInfo& info);
+        PlayerActivity(const Domain::StreamInfo& info, const Domain::PlayQueue& queue = Domain::PlayQueue());
         ~PlayerActivity() override;
 
         brls::View* createContentView() override;
 
     private:
         Domain::StreamInfo streamInfo;
+        Domain::PlayQueue queue;
+        int startFormat = -1;
     };
 
 } // namespace Presentation
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <borealis.hpp>
+#include <borealis/views/recycler.hpp>
+#include "../domain/video_page.hpp"
+#include "view/thumbnail_image.hpp"
+#include <vector>
+#include <functional>
+#include <memory>
+#include <atomic>
+
+namespace DarkTube {
+namespace Presentation {
+
+    // One video card: thumbnail + title + channel line. Rebound in place when recycled.
+    class VideoCard : public brls::Box {
+    public:
+        VideoCard();
+        ~VideoCard() override;
+
+        void setVideo(const Domain::VideoRef& video);
+        void clearVideo();
+
+        ThumbnailImage* thumbnail;
+        std::function<void()> onPlay;
+        // Fired as soon as the thumbnail gains focus
+        std::function<void()> onFocus;
+        // Fired once the thumbnail has kept focus for prefetchDwellMs
+        std::function<void()> onFocusDwell;
+
+        static long prefetchDwellMs;
+
+    private:
+        brls::Label* titleLabel;
+        brls::Label* channelLabel;
+
+        size_t focusSerial = 0; // Bumped on every focus/rebind to drop stale dwell timers
+        std::shared_ptr<bool> alive = std::make_shared<bool>(true);
+    };
+
+    // A recycled grid row holding `Columns` cards
+    class VideoGridCell : public brls::RecyclerCell {
+    public:
+        static constexpr int Columns = 4;
+        static constexpr float RowHeight = 230;
+
+        VideoGridCell();
+        static VideoGridCell* create();
+
+        // Scrolled out of view: stop downloading thumbnails nobody will see
+        void cacheForReuse() override;
+
+        VideoCard* cards[Columns];
+    };
+
+    // Feeds HomeActivity::currentVideos into a RecyclerFrame, so only rows near the
+    // viewport exist as views no matter how many pages were loaded
+    class VideoGridDataSource : public brls::RecyclerDataSource {
+    public:
+        using PlayHandler = std::function<void(const Domain::VideoRef&)>;
+
+        VideoGridDataSource(const std::vector<Domain::VideoRef>* videos, PlayHandler onPlay, std::function<void()> onNearEnd);
+
+        int numberOfRows(brls::RecyclerFrame* recycler, int section) override;
+        brls::RecyclerCell* cellForRow(brls::RecyclerFrame* recycler, brls::IndexPath index) override;
+        float heightForRow(brls::RecyclerFrame* recycler, brls::IndexPath index) override;
+
+    private:
+        const std::vector<Domain::VideoRef>* videos;
+        PlayHandler onPlay;
+        std::function<void()> onNearEnd;
+
+        // Index of the focused video; thumbnails closest to it download first
+        std::shared_ptr<std::atomic<long>> focusedIndex = std::make_shared<std::atomic<long>>(0);
+    };
+
+} // namespace Presentation
+} // namespace DarkTube
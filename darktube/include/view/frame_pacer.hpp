@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <borealis/core/singleton.hpp>
+
+namespace brls {
+class View;
+}
+
+// Slows the main loop down while nothing on screen changes. borealis' mainLoop always
+// draws, so an idle frame can't be skipped outright; instead the loop sleeps before
+// it, polling input so a press still gets a frame right away.
+//
+// The loop counts as busy while a button or touch is held, focus moves, or something
+// calls wake() (a new mpv frame, a decoded thumbnail, a network result), and for
+// IdleAfter past that so the animations it started can finish.
+class FramePacer : public brls::Singleton<FramePacer> {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::milliseconds IdleAfter{1500};
+
+    // Called once per frame from the main loop, before mainLoop; sleeps while idle
+    void pace();
+
+    // Something is about to change on screen. Safe from any thread.
+    void wake() { woken = true; }
+
+    bool isIdle() const { return idle; }
+
+    bool isEnabled() const { return enabled; }
+    void setEnabled(bool enabled);
+
+    void setIdleFps(float fps) { idleFrameTime = std::chrono::duration<double>(1.0 / (fps > 0 ? fps : 1)); }
+
+private:
+    bool pollActivity();
+
+    bool enabled = true;
+    bool idle = false;
+    std::atomic<bool> woken{false};
+    Clock::time_point lastActivity = Clock::now();
+    Clock::time_point lastFrame = Clock::now();
+    std::chrono::duration<double> idleFrameTime{1.0 / 15};
+    brls::View* lastFocus = nullptr;
+};
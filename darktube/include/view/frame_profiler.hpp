@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <borealis/core/singleton.hpp>
+
+// Per-frame timings of the main loop, split into the phases DarkTube controls, kept in
+// a ring buffer of the last Capacity frames. Whatever the phases don't cover (input,
+// animations, NanoVG flush, buffer swap and vsync wait) is reported as Other.
+// Main thread only.
+class FrameProfiler : public brls::Singleton<FrameProfiler> {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum Phase {
+        Sync,    // brls::sync callbacks (network results, mpv events, and the layouts they trigger)
+        Draw,    // building the NanoVG frame for the view tree
+        Video,   // mpv_render_context_render
+        Uploads, // ThumbnailLoader::processUploads
+        Idle,    // FramePacer sleeping out an idle frame; not part of totalMs
+        Other,
+        PhaseCount
+    };
+
+    static constexpr size_t Capacity = 600; // 10 s at 60 fps
+
+    struct Frame {
+        uint64_t index = 0;
+        float totalMs = 0; // busy time: the frame less the Idle phase
+        float phaseMs[PhaseCount] = {};
+        float inputLatencyMs = -1; // press to the end of the frame that showed it, -1 if none
+    };
+
+    // Times a phase; a nested scope's time is taken out of the enclosing one
+    class Scope {
+    public:
+        explicit Scope(Phase phase);
+        ~Scope();
+
+    private:
+        Phase phase;
+        Clock::time_point start;
+        Scope* parent;
+        double childMs = 0;
+    };
+
+    void beginFrame();
+    void endFrame();
+
+    // A button press whose effect the next drawn frame should show
+    void markInput();
+    // Called by ProfiledBox once the view tree has been drawn
+    void markDrawn() { lastDrawn = Clock::now(); }
+
+    // Oldest first
+    std::vector<Frame> getFrames() const;
+    uint64_t getFrameCount() const { return frameCount; }
+    float getLastInputLatencyMs() const { return lastInputLatencyMs; }
+
+    // Writes every buffered frame as CSV
+    bool dump(const std::string& path) const;
+
+    bool isOverlayVisible() const { return overlayVisible; }
+    void setOverlayVisible(bool visible) { overlayVisible = visible; }
+
+    static const char* phaseName(Phase phase);
+
+private:
+    Frame frames[Capacity];
+    uint64_t frameCount = 0;
+    Frame current;
+    Clock::time_point frameStart;
+
+    Scope* activeScope = nullptr;
+
+    bool inputPending = false;
+    Clock::time_point inputTime;
+    Clock::time_point lastDrawn;
+    float lastInputLatencyMs = -1;
+
+    bool overlayVisible = false;
+};
@@ -2,12 +2,17 @@
 
 #include <string>
 #include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
 #include <borealis/core/geometry.hpp>
 #include <borealis/core/singleton.hpp>
 #include <borealis/core/logger.hpp>
 #include <mpv/client.h>
 #include <mpv/render.h>
 #include <mpv/render_gl.h>
+#include "../domain/cache_profile.hpp"
 
 #ifdef __SDL2__
 #include <SDL2/SDL.h>
@@ -23,14 +28,57 @@ public:
     MPVCore();
     ~MPVCore();
 
-    void setUrl(const std::string &url, const std::string &audioUrl = "");
+    // What the player is doing, as of the last mpv event. version changes with every update.
+    struct PlaybackState {
+        uint64_t version = 0;
+        bool stopped = true;
+        bool playing = false;
+        bool buffering = false;
+        bool eof = false;
+        double time = 0;
+        double duration = 0;
+        double cacheSeconds = 0;    // demuxed ahead of the playback position
+        double inputBytesPerSec = 0; // current download rate into the cache
+        bool cacheIdle = true;       // the cache is full or done, so inputBytesPerSec isn't a bandwidth
+        double cacheBytes = 0;       // packets held, ahead and behind
+        uint64_t playlistItem = 0;   // counts the moves to a file queued with queueNext()
+
+        bool isPaused() const { return !playing && !stopped; }
+        float progress() const { return duration > 0 ? (float)(time / duration) : 0; }
+    };
+
+    // Consistent copy of the state; never blocks, safe from any thread
+    PlaybackState getState() const;
+
+    // startSeconds > 0 starts playback there instead of at the beginning
+    void setUrl(const std::string &url, const std::string &audioUrl = "", double startSeconds = 0);
     void draw(brls::Rect rect, float alpha = 1.0);
 
+    // Demuxer cache limits for the files loaded from now on
+    void setCacheProfile(const DarkTube::Domain::CacheProfile &profile);
+    const DarkTube::Domain::CacheProfile &getCacheProfile() const { return cacheProfile; }
+    // Memory the process could still allocate, 0 if the platform doesn't say
+    static uint64_t getAvailableMemory();
+
+    // Changes the stream of the playing video and keeps the position. When seamless, the
+    // new stream buffers on a muted, paused second player while this one keeps playing,
+    // and updateSwitch() swaps it in once enough is cached; otherwise it is reloaded in place.
+    void switchUrl(const std::string &url, const std::string &audioUrl, bool seamless);
+    // Appends `url` to mpv's playlist, replacing any earlier one, so mpv prefetches it and
+    // moves on to it at the end of the current file; empty clears it
+    void queueNext(const std::string &url);
+    // Time from the end of one file to the first frame of the next, -1 before any
+    double getLastGapMs() const { return lastGapMs.load(); }
+
+    // Drives a pending switch; call every frame from the main thread
+    void updateSwitch();
+    bool isSwitching() const { return switchMode != SWITCH_NONE; }
+
     bool isStopped() const;
     bool isPlaying() const;
     bool isPaused() const;
     bool isBuffering() const;
-    bool isEOF() const { return eof_reached; }
+    bool isEOF() const;
 
     void resume();
     void pause();
@@ -39,29 +87,29 @@ public:
     void restart();
     void setVolume(int64_t value);
 
-    double getDuration() const { return duration; }
-    double getPlaybackTime() const { return playback_time; }
-    float getPlaybackProgress() const { 
-        if (duration <= 0) return 0;
-        return (float)(playback_time / duration);
-    }
+    double getDuration() const { return getState().duration; }
+    double getPlaybackTime() const { return getState().time; }
+    float getPlaybackProgress() const { return getState().progress(); }
 
     mpv_render_context *getContext();
     mpv_handle *getHandle();
 
-    bool video_stopped = true;
-    bool video_playing = false;
-    bool buffering = false;
+    // How often mpv signalled versus how many main thread tasks that cost
+    struct CallbackStats {
+        uint64_t updateSignals = 0;
+        uint64_t updatePosts = 0;
+    };
+    CallbackStats getCallbackStats() const;
+
     bool redraw = false;
-    bool eof_reached = false;
-    double duration = 0;
-    double playback_time = 0;
 
 private:
     mpv_handle *mpv = nullptr;
     mpv_render_context *mpv_context = nullptr;
     brls::Rect rect = {0, 0, 1920, 1080};
-    std::string pendingAudioUrl;  // External audio to add after file loads
+    std::string pendingAudioUrl;  // External audio to add after file loads, guarded by stateMutex
+    DarkTube::Domain::CacheProfile cacheProfile;
+    std::string nextUrl; // queued after the current file, guarded by stateMutex
 
     int default_framebuffer = 0;
     int flip_y = 1; // 1 to enable flipping vertically in OpenGL
@@ -76,10 +124,64 @@ private:
     void init();
     void clean();
     void setFrameSize(brls::Rect rect);
-    void eventMainLoop();
+    void eventLoop();
+    void handleProperty(mpv_event_property *prop, uint64_t id);
+    void publishState();
+    void startGap();
+    void reportCallbackStats();
+    bool startStandby(const std::string &url, const std::string &audioUrl, double startSeconds);
+    bool pollStandby();
+    void swapInStandby(double cacheEnd);
+    void dropStandby();
+    void reload(const std::string &url, const std::string &audioUrl);
 
     static void on_update(void *self);
-    static void on_wakeup(void *self);
+
+    // mpv events are drained on eventThread, which publishes `state` through a seqlock:
+    // stateVersion is odd while a write is in progress, and readers retry until they see
+    // the same even version on both sides of their copy. Writers (the event thread and
+    // the playback commands) serialise on stateMutex.
+    std::thread eventThread;
+    std::atomic<bool> eventThreadRunning{false};
+    std::mutex stateMutex;
+    PlaybackState state;
+    std::atomic<uint64_t> stateVersion{0};
+    std::atomic<uint32_t> publishedFlags{0};
+    std::atomic<double> publishedTime{0};
+    std::atomic<double> publishedDuration{0};
+    std::atomic<double> publishedCacheSeconds{0};
+    std::atomic<double> publishedInputRate{0};
+    std::atomic<double> publishedCacheBytes{0};
+    std::atomic<uint64_t> publishedPlaylistItem{0};
+    std::atomic<uint64_t> fileLoads{0}; // MPV_EVENT_FILE_LOADED count, to tell when a reload is in
+
+    // Gap between videos: from the end of a file (or eof-reached) to the next playback
+    // restart that followed a file load. Event thread only, apart from lastGapMs.
+    bool gapPending = false;
+    bool gapLoaded = false;
+    std::chrono::steady_clock::time_point gapStartedAt;
+    std::atomic<double> lastGapMs{-1};
+
+    // A quality switch in progress. The standby player has its own handle and render
+    // context and is only touched from the main thread; its events are drained there.
+    enum SwitchMode { SWITCH_NONE, SWITCH_RELOAD, SWITCH_STANDBY };
+    SwitchMode switchMode = SWITCH_NONE;
+    mpv_handle *standby = nullptr;
+    mpv_render_context *standbyContext = nullptr;
+    std::string switchTarget;
+    std::string switchAudio;
+    double standbyStart = 0;
+    bool standbyLoaded = false;
+    uint64_t switchLoads = 0;
+    std::chrono::steady_clock::time_point switchStartedAt;
+    std::chrono::steady_clock::time_point switchPolledAt;
+
+    // Set while an update task is queued, so mpv's callback posts at most one
+    std::atomic<bool> updatePending{false};
+    std::atomic<uint64_t> updateSignals{0};
+    std::atomic<uint64_t> updatePosts{0};
+    CallbackStats reportedStats;
+    std::chrono::steady_clock::time_point reportedAt;
 
     brls::Event<bool>::Subscription focusSubscription;
     brls::Event<>::Subscription exitDoneEventSubscription;
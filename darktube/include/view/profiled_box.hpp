@@ -0,0 +1,16 @@
+#pragma once
+
+#include <borealis.hpp>
+
+// Root box of an activity. Times the NanoVG pass over everything below it for
+// FrameProfiler and draws the profiler overlay on top when it is enabled.
+// R3 toggles the overlay, L3 writes the buffered frames to a CSV file.
+class ProfiledBox : public brls::Box {
+public:
+    ProfiledBox();
+
+    void draw(NVGcontext* vg, float x, float y, float width, float height, brls::Style style, brls::FrameContext* ctx) override;
+
+private:
+    void drawOverlay(NVGcontext* vg, float x, float y, float width);
+};
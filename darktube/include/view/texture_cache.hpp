@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <borealis/core/singleton.hpp>
+
+// Decoded thumbnails shared by every card, keyed by URL. Textures are reference
+// counted; unused ones stay cached (LRU) until the byte budget is exceeded.
+// Main thread only, like every NanoVG call.
+class TextureCache : public brls::Singleton<TextureCache> {
+public:
+    // Returns the cached texture and takes a reference, or -1 on a miss
+    int acquire(const std::string& url);
+
+    // Uploads `rgba` (unless another card beat us to it) and takes a reference
+    int insert(const std::string& url, const unsigned char* rgba, int width, int height);
+
+    void release(const std::string& url);
+
+    void setMaxBytes(size_t bytes);
+
+    size_t getHits() const { return hits; }
+    size_t getMisses() const { return misses; }
+    size_t getBytes() const { return totalBytes; }
+    size_t getCount() const { return entries.size(); }
+    void logStats() const;
+
+private:
+    struct Entry {
+        int texture;
+        size_t bytes;
+        int refs;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    void touch(Entry& entry);
+    void evict();
+
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lru; // front = most recently used
+    size_t totalBytes = 0;
+    size_t maxBytes = 32 * 1024 * 1024;
+
+    size_t hits = 0;
+    size_t misses = 0;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <borealis/views/image.hpp>
+#include "../data/cancel_token.hpp"
+#include "../data/request_priority.hpp"
+
+// Card thumbnail backed by the shared TextureCache. The texture is borrowed,
+// never owned, and the cache reference is dropped when the view goes away.
+class ThumbnailImage : public brls::Image {
+public:
+    ~ThumbnailImage() override;
+
+    // Shows the cached texture right away, otherwise loads it in the background. An
+    // empty url shows the placeholder.
+    void setThumbnailUrl(const std::string& url);
+    // Aborts a pending download; a later setThumbnailUrl with the same url starts over
+    void cancelLoad();
+    // Used for downloads started after this call (RequestPriority::Thumbnail if unset)
+    void setLoadPriority(DarkTube::Data::PriorityFn priority) { loadPriority = priority; }
+
+    // Called by ThumbnailLoader on the main thread once `url` is decoded
+    void onThumbnailDecoded(const std::string& url, const std::vector<unsigned char>& pixels);
+
+private:
+    void showTexture(int texture);
+    void showPlaceholder();
+    void releaseTexture();
+
+    std::string url;
+    bool holdsTexture = false;
+    bool showsPlaceholder = false;
+    DarkTube::Data::CancelTokenPtr loadToken;
+    DarkTube::Data::PriorityFn loadPriority;
+    std::shared_ptr<bool> alive = std::make_shared<bool>(true);
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <borealis/core/singleton.hpp>
+#include "../data/cancel_token.hpp"
+#include "../data/request_priority.hpp"
+
+class ThumbnailImage;
+
+// Loads video thumbnails without touching the UI thread until the pixels are ready:
+// download and decode + downscale to the card size happen on workers, the main
+// thread only uploads finished RGBA buffers, a few textures per frame.
+class ThumbnailLoader : public brls::Singleton<ThumbnailLoader> {
+public:
+    // Card size used by the home grid
+    static constexpr int Width = 256;
+    static constexpr int Height = 144;
+
+    // `alive` guards `image`: once it is false the result is dropped.
+    // Cancelling `token` aborts the download and skips the decode.
+    void load(ThumbnailImage* image, const std::string& url, std::shared_ptr<bool> alive, DarkTube::Data::CancelTokenPtr token,
+              DarkTube::Data::PriorityFn priority = nullptr);
+
+    // Called once per frame from the main loop
+    void processUploads();
+
+    void setMaxUploadsPerFrame(size_t max) { maxUploadsPerFrame = max > 0 ? max : 1; }
+
+private:
+    struct DecodedThumbnail {
+        ThumbnailImage* image = nullptr;
+        std::shared_ptr<bool> alive;
+        std::string url;
+        std::vector<unsigned char> pixels; // Width x Height RGBA, empty on failure
+    };
+
+    static bool decode(const std::string& data, std::vector<unsigned char>& pixels);
+
+    std::mutex uploadMutex;
+    std::deque<DecodedThumbnail> uploads;
+    size_t maxUploadsPerFrame = 4;
+};
@@ -0,0 +1,95 @@
+#include "../include/data/http_connection_pool.hpp"
+
+namespace DarkTube {
+namespace Data {
+
+    HttpConnectionPool::HttpConnectionPool() {
+        share = curl_share_init();
+        if (share) {
+            curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lockShare);
+            curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+            curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+        }
+    }
+
+    HttpConnectionPool::~HttpConnectionPool() {
+        clear();
+        if (share) {
+            curl_share_cleanup(share);
+            share = nullptr;
+        }
+    }
+
+    void HttpConnectionPool::lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr) {
+        auto* pool = static_cast<HttpConnectionPool*>(userptr);
+        pool->shareLocks[data].lock();
+    }
+
+    void HttpConnectionPool::unlockShare(CURL* handle, curl_lock_data data, void* userptr) {
+        auto* pool = static_cast<HttpConnectionPool*>(userptr);
+        pool->shareLocks[data].unlock();
+    }
+
+    std::string HttpConnectionPool::serverKey(const std::string& url) {
+        // scheme://host[:port] is enough to group handles per server
+        size_t schemeEnd = url.find("://");
+        size_t hostStart = schemeEnd == std::string::npos ? 0 : schemeEnd + 3;
+        size_t hostEnd = url.find('/', hostStart);
+        return url.substr(0, hostEnd);
+    }
+
+    void HttpConnectionPool::prepare(CURL* handle) {
+        if (share) curl_easy_setopt(handle, CURLOPT_SHARE, share);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    }
+
+    CURL* HttpConnectionPool::acquire(const std::string& url) {
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            auto it = idleHandles.find(serverKey(url));
+            if (it != idleHandles.end() && !it->second.empty()) {
+                CURL* handle = it->second.back();
+                it->second.pop_back();
+                return handle;
+            }
+        }
+
+        CURL* handle = curl_easy_init();
+        if (handle) prepare(handle);
+        return handle;
+    }
+
+    void HttpConnectionPool::release(const std::string& url, CURL* handle) {
+        if (!handle) return;
+
+        // Reset per-request options (buffers, callbacks) but keep the handle's connection
+        curl_easy_reset(handle);
+        prepare(handle);
+
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            auto& handles = idleHandles[serverKey(url)];
+            if (handles.size() < MaxIdlePerServer) {
+                handles.push_back(handle);
+                return;
+            }
+        }
+        curl_easy_cleanup(handle);
+    }
+
+    void HttpConnectionPool::clear() {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        for (auto& entry : idleHandles) {
+            for (CURL* handle : entry.second) {
+                curl_easy_cleanup(handle);
+            }
+        }
+        idleHandles.clear();
+    }
+
+} // namespace Data
+} // namespace DarkTube
@@ -0,0 +1,266 @@
+#include "../include/data/http_reactor.hpp"
+#include <borealis/core/logger.hpp>
+#include <borealis/core/thread.hpp>
+#include <vector>
+#include <algorithm>
+
+namespace DarkTube {
+namespace Data {
+
+    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+        HttpResponse* response = (HttpResponse*)userp;
+        response->bodyBytes += size * nmemb;
+        if (response->sink) {
+            return response->sink->write((const char*)contents, size * nmemb) ? size * nmemb : 0;
+        }
+        response->body.append((char*)contents, size * nmemb);
+        return size * nmemb;
+    }
+
+    HttpReactor::HttpReactor(HttpConnectionPool* pool) : pool(pool) {
+        multi = curl_multi_init();
+        // Requests to the same server share one h2 connection instead of opening one each
+        curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+        std::string encodings;
+        curl_version_info_data* version = curl_version_info(CURLVERSION_NOW);
+        if (version) {
+            http2 = (version->features & CURL_VERSION_HTTP2) != 0;
+            if (version->features & CURL_VERSION_LIBZ) encodings += "gzip ";
+            if (version->features & CURL_VERSION_BROTLI) encodings += "br ";
+#ifdef CURL_VERSION_ZSTD
+            if (version->features & CURL_VERSION_ZSTD) encodings += "zstd ";
+#endif
+            if (!encodings.empty()) encodings.pop_back();
+        }
+        brls::Logger::info("Network: HTTP/2 {}, encodings: {}", http2 ? "available" : "unavailable, using HTTP/1.1",
+            encodings.empty() ? "none" : encodings);
+
+        worker = std::thread(&HttpReactor::run, this);
+    }
+
+    HttpReactor::~HttpReactor() {
+        running = false;
+        curl_multi_wakeup(multi);
+        if (worker.joinable()) worker.join();
+
+        // Whatever is left is dropped without running its completion
+        for (Transfer* t : pending) delete t;
+        pending.clear();
+        curl_multi_cleanup(multi);
+    }
+
+    void HttpReactor::submit(const HttpRequest& request, Completion done) {
+        Transfer* t = new Transfer();
+        t->request = request;
+        t->done = std::move(done);
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            pending.push_back(t);
+        }
+        rescheduleNeeded = true;
+        curl_multi_wakeup(multi);
+    }
+
+    void HttpReactor::wakeup() {
+        rescheduleNeeded = true;
+        curl_multi_wakeup(multi);
+    }
+
+    void HttpReactor::setMaxConcurrentTransfers(size_t max) {
+        maxConcurrent = max > 0 ? max : 1;
+        rescheduleNeeded = true;
+        curl_multi_wakeup(multi);
+    }
+
+    HttpReactor::Stats HttpReactor::getStats() const {
+        Stats stats;
+        stats.transfers = transferCount;
+        stats.http2Transfers = http2Count;
+        stats.connections = connectionCount;
+        stats.wireBytes = wireBytes;
+        stats.bodyBytes = bodyBytes;
+        return stats;
+    }
+
+    void HttpReactor::startPending() {
+        if (!rescheduleNeeded.exchange(false)) return;
+
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (pending.empty() || inFlight.size() >= maxConcurrent) return;
+
+        // Most urgent first; equal priorities keep their submission order
+        std::vector<std::pair<int, Transfer*>> order;
+        order.reserve(pending.size());
+        for (Transfer* t : pending) {
+            order.emplace_back(t->request.priority ? t->request.priority() : RequestPriority::Page, t);
+        }
+        std::stable_sort(order.begin(), order.end(), [](const std::pair<int, Transfer*>& a, const std::pair<int, Transfer*>& b) {
+            return a.first < b.first;
+        });
+
+        size_t background = 0;
+        for (Transfer* t : inFlight) {
+            if (t->background) background++;
+        }
+        size_t maxBackground = maxConcurrent > ReservedSlots ? maxConcurrent - ReservedSlots : 1;
+
+        std::unordered_set<Transfer*> taken;
+        for (auto& entry : order) {
+            if (inFlight.size() >= maxConcurrent) break;
+            Transfer* t = entry.second;
+            bool isBackground = entry.first >= RequestPriority::Thumbnail;
+            // Everything after this one is background work too
+            if (isBackground && background >= maxBackground) break;
+
+            taken.insert(t);
+
+            // Nobody wants it any more: don't spend a slot on it
+            if (t->request.cancelled && t->request.cancelled()) {
+                t->response.code = CURLE_ABORTED_BY_CALLBACK;
+                complete(t);
+                continue;
+            }
+
+            t->background = isBackground;
+            if (isBackground) background++;
+            start(t);
+        }
+
+        pending.erase(std::remove_if(pending.begin(), pending.end(), [&taken](Transfer* t) { return taken.count(t) > 0; }), pending.end());
+    }
+
+    void HttpReactor::start(Transfer* t) {
+        t->handle = pool->acquire(t->request.url);
+        if (!t->handle) {
+            t->response.code = CURLE_FAILED_INIT;
+            complete(t);
+            return;
+        }
+
+        t->response.sink = t->request.sink;
+        CURL* curl = t->handle;
+        brls::Logger::info("Network: GET {}", t->request.url);
+        curl_easy_setopt(curl, CURLOPT_URL, t->request.url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &t->response);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, t->request.timeoutSec);
+        curl_easy_setopt(curl, CURLOPT_PRIVATE, t);
+        if (t->request.headOnly) curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+
+        // Disable SSL verify for local servers if needed
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+
+        // Empty string: offer every encoding this libcurl decodes. The server picks one
+        // (or none), and the body reaches the write callback already decoded.
+        curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+        if (http2) {
+            // h2 is negotiated through ALPN on https:// only; plain http:// and servers
+            // that don't offer h2 stay on HTTP/1.1 keep-alive
+            curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+            // While the first connection's protocol is unknown, queue on it rather than
+            // opening a parallel one per request
+            curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+        }
+
+        curl_multi_add_handle(multi, curl);
+        inFlight.insert(t);
+    }
+
+    void HttpReactor::abortCancelled() {
+        std::vector<CURL*> aborted;
+        for (Transfer* t : inFlight) {
+            if (t->request.cancelled && t->request.cancelled()) aborted.push_back(t->handle);
+        }
+        for (CURL* handle : aborted) finish(handle, CURLE_ABORTED_BY_CALLBACK);
+    }
+
+    void HttpReactor::complete(Transfer* t) {
+        // Parsing/decoding happens on a worker, never on the network thread
+        Completion done = std::move(t->done);
+        HttpResponse response = std::move(t->response);
+        delete t;
+        brls::async([done, response]() mutable { done(response); });
+    }
+
+    void HttpReactor::finish(CURL* handle, CURLcode result) {
+        Transfer* t = nullptr;
+        curl_easy_getinfo(handle, CURLINFO_PRIVATE, (char**)&t);
+        curl_multi_remove_handle(multi, handle);
+        inFlight.erase(t);
+
+        t->response.code = result;
+        curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &t->response.status);
+        recordStats(handle, t->response);
+        if (result == CURLE_ABORTED_BY_CALLBACK) {
+            brls::Logger::debug("Network: cancelled {}", t->request.url);
+        } else if (result != CURLE_OK) {
+            brls::Logger::error("Network: {} failed: {}", t->request.url, curl_easy_strerror(result));
+        }
+        pool->release(t->request.url, handle);
+        complete(t);
+        rescheduleNeeded = true;
+    }
+
+    void HttpReactor::recordStats(CURL* handle, const HttpResponse& response) {
+        long connects = 0;
+        long version = 0;
+        curl_off_t downloaded = 0;
+        curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+        curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &version);
+        curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+
+        transferCount++;
+        if (version == CURL_HTTP_VERSION_2_0) http2Count++;
+        connectionCount += connects;
+        wireBytes += (size_t)downloaded;
+        bodyBytes += response.bodyBytes;
+
+        // Timed from the request going out, so server think time counts against the link;
+        // parallel transfers share it too. Both err low, which is the safe side for
+        // picking a starting quality.
+        if (response.ok() && response.status < 400 && downloaded >= Domain::BandwidthEstimator::MinSampleBytes) {
+            curl_off_t total = 0;
+            curl_off_t pretransfer = 0;
+            curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &total);
+            curl_easy_getinfo(handle, CURLINFO_PRETRANSFER_TIME_T, &pretransfer);
+            bandwidth.addSample((double)downloaded, (total - pretransfer) / 1e6);
+        }
+    }
+
+    void HttpReactor::run() {
+        while (running) {
+            // Aborting first frees slots for the queue
+            abortCancelled();
+            startPending();
+
+            int stillRunning = 0;
+            curl_multi_perform(multi, &stillRunning);
+
+            bool finishedAny = false;
+            int queued = 0;
+            while (CURLMsg* msg = curl_multi_info_read(multi, &queued)) {
+                if (msg->msg == CURLMSG_DONE) {
+                    finish(msg->easy_handle, msg->data.result);
+                    finishedAny = true;
+                }
+            }
+
+            // Freed slots can be refilled right away
+            if (finishedAny) continue;
+
+            curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+        }
+
+        // Abort in-flight transfers on shutdown
+        for (Transfer* t : inFlight) {
+            curl_multi_remove_handle(multi, t->handle);
+            pool->release(t->request.url, t->handle);
+            delete t;
+        }
+        inFlight.clear();
+    }
+
+} // namespace Data
+} // namespace DarkTube
@@ -1,5 +1,8 @@
 #include "../include/data/ip_repository.hpp"
 #include <fstream>
+#include <cstdio>
+#include <unistd.h>
+#include <algorithm>
 #include <nlohmann/json.hpp>
 #include <borealis/core/logger.hpp>
 
@@ -14,78 +17,134 @@ using json = nlohmann::json;
 namespace DarkTube {
 namespace Data {
 
+    static const std::string TempPath = std::string(CONFIG_PATH) + ".tmp";
+
+    // API root for a server address, which may be a bare host or a full URL
+    static std::string baseUrlOf(const std::string& address) {
+        if (address.empty()) return "";
+        if (address.find("http") == std::string::npos) {
+            return "http://" + address + ":3000";
+        }
+        return address;
+    }
+
     IPRepository::IPRepository() {
-        m_activeServer = {"", "", ""};
+        auto initial = std::make_unique<ConfigSnapshot>();
+        current.store(initial.get());
+        snapshots.push_back(std::move(initial));
         loadFromFile();
+        writer = std::thread(&IPRepository::writerLoop, this);
+    }
+
+    IPRepository::~IPRepository() {
+        {
+            std::lock_guard<std::mutex> lock(saveMutex);
+            writerRunning = false;
+        }
+        saveCondition.notify_all();
+        writer.join(); // writes whatever is still queued first
+    }
+
+    // Copies the current snapshot, lets `change` edit the copy and publishes it
+    void IPRepository::update(const std::function<void(ConfigSnapshot&)>& change) {
+        std::lock_guard<std::mutex> lock(updateMutex);
+        auto next = std::make_unique<ConfigSnapshot>(getConfig());
+        change(*next);
+        next->version++;
+        next->baseUrl = baseUrlOf(next->activeServer.address);
+        current.store(next.get(), std::memory_order_release);
+        snapshots.push_back(std::move(next));
     }
 
     std::vector<Domain::ServerIP> IPRepository::getSavedServers() {
-        return m_servers;
+        return getConfig().servers;
     }
 
     void IPRepository::addServer(const Domain::ServerIP& server) {
-        m_servers.push_back(server);
+        update([&](ConfigSnapshot& next) { next.servers.push_back(server); });
         saveToFile();
     }
 
     void IPRepository::removeServer(const std::string& id) {
-        for (auto it = m_servers.begin(); it != m_servers.end(); ++it) {
-            if (it->id == id) {
-                m_servers.erase(it);
-                saveToFile();
-                break;
-            }
-        }
+        bool removed = false;
+        update([&](ConfigSnapshot& next) {
+            auto it = std::find_if(next.servers.begin(), next.servers.end(), [&](const Domain::ServerIP& s) { return s.id == id; });
+            if (it == next.servers.end()) return;
+            next.servers.erase(it);
+            removed = true;
+        });
+        if (removed) saveToFile();
     }
 
     void IPRepository::setActiveServer(const Domain::ServerIP& server) {
-        m_activeServer = server;
+        update([&](ConfigSnapshot& next) { next.activeServer = server; });
         saveToFile();
+        activeServerChanged.fire(getConfig().activeServer);
     }
 
     void IPRepository::setLanguage(const std::string& lang) {
-        m_language = lang;
+        update([&](ConfigSnapshot& next) { next.language = lang; });
         saveToFile();
     }
 
     void IPRepository::setUseProxy(bool useProxy) {
-        m_useProxy = useProxy;
+        update([&](ConfigSnapshot& next) { next.useProxy = useProxy; });
+        saveToFile();
+    }
+
+    void IPRepository::setPowerSaving(bool powerSaving) {
+        update([&](ConfigSnapshot& next) { next.powerSaving = powerSaving; });
+        saveToFile();
+    }
+
+    void IPRepository::setDiskCache(bool diskCache) {
+        update([&](ConfigSnapshot& next) { next.diskCache = diskCache; });
         saveToFile();
     }
 
     void IPRepository::updateServer(const Domain::ServerIP& server) {
-        for (auto& s : m_servers) {
-            if (s.id == server.id) {
-                s.name = server.name;
-                s.address = server.address;
-
-                // Also update active server if this was it
-                if (m_activeServer.id == server.id) {
-                    m_activeServer = s;
+        bool found = false;
+        bool activeChanged = false;
+        update([&](ConfigSnapshot& next) {
+            for (auto& s : next.servers) {
+                if (s.id == server.id) {
+                    s.name = server.name;
+                    s.address = server.address;
+                    found = true;
+
+                    // Also update active server if this was it
+                    activeChanged = next.activeServer.id == server.id;
+                    if (activeChanged) {
+                        next.activeServer = s;
+                    }
+                    break;
                 }
-                
-                saveToFile();
-                break;
             }
-        }
+        });
+        if (!found) return;
+
+        saveToFile();
+        if (activeChanged) activeServerChanged.fire(getConfig().activeServer);
     }
 
     Domain::ServerIP IPRepository::getActiveServer() const {
-        return m_activeServer;
+        return getConfig().activeServer;
     }
 
     bool IPRepository::loadFromFile() {
         std::ifstream file(CONFIG_PATH);
+        // Interrupted between replacing the file and renaming the new one into place
+        if (!file.is_open()) file.open(TempPath);
         if (!file.is_open()) return false;
 
         try {
             json j;
             file >> j;
 
-            m_servers.clear();
+            ConfigSnapshot loaded;
             if (j.contains("servers")) {
                 for (auto& item : j["servers"]) {
-                    m_servers.push_back({
+                    loaded.servers.push_back({
                         item.value("id", ""),
                         item.value("name", ""),
                         item.value("address", "")
@@ -95,7 +154,7 @@ namespace Data {
 
             if (j.contains("activeServer")) {
                 auto& active = j["activeServer"];
-                m_activeServer = {
+                loaded.activeServer = {
                     active.value("id", ""),
                     active.value("name", ""),
                     active.value("address", "")
@@ -103,14 +162,27 @@ namespace Data {
             }
 
             if (j.contains("language")) {
-                m_language = j.value("language", "en-US");
+                loaded.language = j.value("language", "en-US");
             }
 
             if (j.contains("useProxy")) {
-                m_useProxy = j.value("useProxy", false);
+                loaded.useProxy = j.value("useProxy", false);
             }
-            
-            brls::Logger::info("IPRepository: Loaded {} servers", m_servers.size());
+
+            if (j.contains("powerSaving")) {
+                loaded.powerSaving = j.value("powerSaving", true);
+            }
+
+            if (j.contains("diskCache")) {
+                loaded.diskCache = j.value("diskCache", false);
+            }
+            update([&](ConfigSnapshot& next) {
+                loaded.version = next.version;
+                next = std::move(loaded);
+            });
+
+            brls::Logger::info("IPRepository: Loaded {} servers", getConfig().servers.size());
+            writtenConfig = serialize(); // the writer isn't running yet
             return true;
         } catch (...) {
             brls::Logger::error("IPRepository: Failed to parse config");
@@ -118,10 +190,11 @@ namespace Data {
         }
     }
 
-    void IPRepository::saveToFile() {
+    std::string IPRepository::serialize() const {
+        const ConfigSnapshot& snapshot = getConfig();
         json j;
         json servers = json::array();
-        for (const auto& s : m_servers) {
+        for (const auto& s : snapshot.servers) {
             servers.push_back({
                 {"id", s.id},
                 {"name", s.name},
@@ -130,18 +203,92 @@ namespace Data {
         }
         j["servers"] = servers;
         j["activeServer"] = {
-            {"id", m_activeServer.id},
-            {"name", m_activeServer.name},
-            {"address", m_activeServer.address}
+            {"id", snapshot.activeServer.id},
+            {"name", snapshot.activeServer.name},
+            {"address", snapshot.activeServer.address}
         };
-        j["language"] = m_language;
-        j["useProxy"] = m_useProxy;
+        j["language"] = snapshot.language;
+        j["useProxy"] = snapshot.useProxy;
+        j["powerSaving"] = snapshot.powerSaving;
+        j["diskCache"] = snapshot.diskCache;
+        return j.dump(4);
+    }
+
+    // Serializing is cheap; the SD card write is what mustn't run on the UI thread
+    void IPRepository::saveToFile() {
+        std::string config = serialize();
+        {
+            std::lock_guard<std::mutex> lock(saveMutex);
+            pendingConfig = std::move(config);
+            savePending = true;
+            lastChange = std::chrono::steady_clock::now();
+        }
+        saveCondition.notify_all();
+    }
+
+    void IPRepository::flush() {
+        std::unique_lock<std::mutex> lock(saveMutex);
+        flushRequested = true;
+        saveCondition.notify_all();
+        saveCondition.wait(lock, [this] { return !savePending && !writing; });
+        flushRequested = false;
+    }
+
+    void IPRepository::writerLoop() {
+        std::unique_lock<std::mutex> lock(saveMutex);
+        while (true) {
+            saveCondition.wait(lock, [this] { return savePending || !writerRunning; });
+            if (!savePending) return;
 
-        std::ofstream file(CONFIG_PATH);
-        if (file.is_open()) {
-            file << j.dump(4);
-            brls::Logger::info("IPRepository: Saved config");
+            // A burst of changes (every setter saves) settles into one write
+            while (writerRunning && !flushRequested && std::chrono::steady_clock::now() < lastChange + SaveDelay) {
+                saveCondition.wait_until(lock, lastChange + SaveDelay);
+            }
+
+            std::string config = std::move(pendingConfig);
+            savePending = false;
+            writing = true;
+            lock.unlock();
+            writeConfig(config);
+            lock.lock();
+            writing = false;
+            saveCondition.notify_all();
+        }
+    }
+
+    // Writer thread. The new config is synced to a temporary file that is then renamed
+    // over the old one, so a crash or power loss mid-write leaves the previous config.
+    void IPRepository::writeConfig(const std::string& config) {
+        if (config == writtenConfig) {
+            brls::Logger::debug("IPRepository: Config unchanged, not saved");
+            return;
+        }
+
+        FILE* file = std::fopen(TempPath.c_str(), "wb");
+        if (!file) {
+            brls::Logger::error("IPRepository: Failed to open {}", TempPath);
+            return;
+        }
+        // fsync before the rename: otherwise the rename can reach the card before the data
+        bool written = std::fwrite(config.data(), 1, config.size(), file) == config.size() &&
+                       std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+        if (std::fclose(file) != 0) written = false;
+        if (!written) {
+            brls::Logger::error("IPRepository: Failed to write {}", TempPath);
+            std::remove(TempPath.c_str());
+            return;
+        }
+
+        // The Switch's SD card driver won't rename over an existing file
+        if (std::rename(TempPath.c_str(), CONFIG_PATH) != 0) {
+            std::remove(CONFIG_PATH);
+            if (std::rename(TempPath.c_str(), CONFIG_PATH) != 0) {
+                brls::Logger::error("IPRepository: Failed to replace config");
+                return;
+            }
         }
+        writtenConfig = config;
+        brls::Logger::info("IPRepository: Saved config");
     }
 
 } // namespace Data
@@ -0,0 +1,278 @@
+#include "../include/data/json_stream_parser.hpp"
+
+namespace DarkTube {
+namespace Data {
+
+    static bool isNumberChar(char c) {
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool JsonStreamParser::fail(const char* reason) {
+        if (error.empty()) {
+            error = std::string("JSON parse error at byte ") + std::to_string(offset) + ": " + reason;
+        }
+        return false;
+    }
+
+    bool JsonStreamParser::beginValue() {
+        if (expect != Expect::Value && expect != Expect::ValueOrEnd) return fail("unexpected value");
+        return true;
+    }
+
+    void JsonStreamParser::afterValue() {
+        expect = stack.empty() ? Expect::Done : Expect::CommaOrEnd;
+    }
+
+    void JsonStreamParser::emitString() {
+        if (stringIsKey) {
+            if (capture) skipNext = !handler->key(buffer);
+            expect = Expect::Colon;
+        } else {
+            if (capture) handler->string(buffer);
+            skipNext = false;
+            afterValue();
+        }
+    }
+
+    void JsonStreamParser::emitNumber() {
+        if (capture) handler->number(buffer);
+        skipNext = false;
+        afterValue();
+    }
+
+    bool JsonStreamParser::emitLiteral() {
+        bool value = buffer == "true";
+        if (!value && buffer != "false" && buffer != "null") return fail("invalid literal");
+
+        if (capture) {
+            if (buffer == "null") {
+                handler->null();
+            } else {
+                handler->boolean(value);
+            }
+        }
+        skipNext = false;
+        afterValue();
+        return true;
+    }
+
+    void JsonStreamParser::appendCodepoint(unsigned int cp) {
+        if (cp < 0x80) {
+            buffer += (char)cp;
+        } else if (cp < 0x800) {
+            buffer += (char)(0xC0 | (cp >> 6));
+            buffer += (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            buffer += (char)(0xE0 | (cp >> 12));
+            buffer += (char)(0x80 | ((cp >> 6) & 0x3F));
+            buffer += (char)(0x80 | (cp & 0x3F));
+        } else {
+            buffer += (char)(0xF0 | (cp >> 18));
+            buffer += (char)(0x80 | ((cp >> 12) & 0x3F));
+            buffer += (char)(0x80 | ((cp >> 6) & 0x3F));
+            buffer += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool JsonStreamParser::structural(char c) {
+        switch (c) {
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                return true;
+            case '{':
+                if (!beginValue()) return false;
+                if (muted()) {
+                    mutedDepth++;
+                    skipNext = false;
+                } else {
+                    handler->startObject();
+                }
+                stack.push_back('{');
+                expect = Expect::KeyOrEnd;
+                return true;
+            case '[':
+                if (!beginValue()) return false;
+                if (muted()) {
+                    mutedDepth++;
+                    skipNext = false;
+                } else {
+                    handler->startArray();
+                }
+                stack.push_back('[');
+                expect = Expect::ValueOrEnd;
+                return true;
+            case '}':
+                if (stack.empty() || stack.back() != '{' || (expect != Expect::KeyOrEnd && expect != Expect::CommaOrEnd)) {
+                    return fail("unexpected '}'");
+                }
+                stack.pop_back();
+                if (mutedDepth > 0) {
+                    mutedDepth--;
+                } else {
+                    handler->endObject();
+                }
+                afterValue();
+                return true;
+            case ']':
+                if (stack.empty() || stack.back() != '[' || (expect != Expect::ValueOrEnd && expect != Expect::CommaOrEnd)) {
+                    return fail("unexpected ']'");
+                }
+                stack.pop_back();
+                if (mutedDepth > 0) {
+                    mutedDepth--;
+                } else {
+                    handler->endArray();
+                }
+                afterValue();
+                return true;
+            case ':':
+                if (expect != Expect::Colon) return fail("unexpected ':'");
+                expect = Expect::Value;
+                return true;
+            case ',':
+                if (expect != Expect::CommaOrEnd) return fail("unexpected ','");
+                expect = stack.back() == '{' ? Expect::Key : Expect::Value;
+                return true;
+            case '"':
+                if (expect == Expect::Key || expect == Expect::KeyOrEnd) {
+                    stringIsKey = true;
+                } else if (beginValue()) {
+                    stringIsKey = false;
+                } else {
+                    return false;
+                }
+                capture = !muted();
+                buffer.clear();
+                lex = Lex::String;
+                return true;
+            default:
+                if (c == '-' || (c >= '0' && c <= '9')) {
+                    if (!beginValue()) return false;
+                    capture = !muted();
+                    buffer.assign(1, c);
+                    lex = Lex::Number;
+                    return true;
+                }
+                if (c == 't' || c == 'f' || c == 'n') {
+                    if (!beginValue()) return false;
+                    capture = !muted();
+                    buffer.assign(1, c);
+                    lex = Lex::Literal;
+                    return true;
+                }
+                return fail("unexpected character");
+        }
+    }
+
+    bool JsonStreamParser::feed(const char* data, size_t size) {
+        if (failed()) return false;
+
+        for (size_t i = 0; i < size; i++, offset++) {
+            char c = data[i];
+            switch (lex) {
+                case Lex::String:
+                    if (c == '"') {
+                        lex = Lex::None;
+                        emitString();
+                    } else if (c == '\\') {
+                        lex = Lex::Escape;
+                    } else if (capture) {
+                        buffer += c;
+                    }
+                    continue;
+                case Lex::Escape:
+                    lex = Lex::String;
+                    if (!capture && c != 'u') continue;
+                    switch (c) {
+                        case '"': buffer += '"'; break;
+                        case '\\': buffer += '\\'; break;
+                        case '/': buffer += '/'; break;
+                        case 'b': buffer += '\b'; break;
+                        case 'f': buffer += '\f'; break;
+                        case 'n': buffer += '\n'; break;
+                        case 'r': buffer += '\r'; break;
+                        case 't': buffer += '\t'; break;
+                        case 'u':
+                            lex = Lex::Unicode;
+                            unicode = 0;
+                            unicodeDigits = 0;
+                            break;
+                        default:
+                            return fail("invalid escape");
+                    }
+                    continue;
+                case Lex::Unicode: {
+                    int v = hexValue(c);
+                    if (v < 0) return fail("invalid \\u escape");
+                    unicode = (unicode << 4) | (unsigned int)v;
+                    if (++unicodeDigits < 4) continue;
+
+                    lex = Lex::String;
+                    if (!capture) continue;
+                    if (unicode >= 0xD800 && unicode <= 0xDBFF) {
+                        highSurrogate = unicode;
+                    } else if (unicode >= 0xDC00 && unicode <= 0xDFFF && highSurrogate) {
+                        appendCodepoint(0x10000 + ((highSurrogate - 0xD800) << 10) + (unicode - 0xDC00));
+                        highSurrogate = 0;
+                    } else {
+                        appendCodepoint(unicode);
+                        highSurrogate = 0;
+                    }
+                    continue;
+                }
+                case Lex::Number:
+                    if (isNumberChar(c)) {
+                        if (capture) buffer += c;
+                        continue;
+                    }
+                    lex = Lex::None;
+                    emitNumber();
+                    break; // `c` still has to be handled below
+                case Lex::Literal:
+                    if (c >= 'a' && c <= 'z') {
+                        buffer += c;
+                        continue;
+                    }
+                    lex = Lex::None;
+                    if (!emitLiteral()) return false;
+                    break;
+                case Lex::None:
+                    break;
+            }
+
+            if (expect == Expect::Done && c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                return fail("trailing data");
+            }
+            if (!structural(c)) return false;
+        }
+        return true;
+    }
+
+    bool JsonStreamParser::finish() {
+        if (failed()) return false;
+
+        // A top-level number or literal has no terminator of its own
+        if (lex == Lex::Number) {
+            lex = Lex::None;
+            emitNumber();
+        } else if (lex == Lex::Literal) {
+            lex = Lex::None;
+            if (!emitLiteral()) return false;
+        }
+
+        if (offset == 0) return fail("empty input");
+        if (lex != Lex::None || expect != Expect::Done) return fail("unexpected end of input");
+        return true;
+    }
+
+} // namespace Data
+} // namespace DarkTube
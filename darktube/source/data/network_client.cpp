@@ -1,276 +1,262 @@
 #include "../include/data/network_client.hpp"
 #include "../include/data/ip_repository.hpp"
 #include <curl/curl.h>
-#include <nlohmann/json.hpp>
 #include <borealis/core/logger.hpp>
 #include <borealis/core/thread.hpp>
 
-using json = nlohmann::json;
-
 namespace DarkTube {
 namespace Data {
 
-    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-        ((std::string*)userp)->append((char*)contents, size * nmemb);
-        return size * nmemb;
-    }
-
     NetworkClient::NetworkClient() {
         curl_global_init(CURL_GLOBAL_DEFAULT);
+        connectionPool = std::make_unique<HttpConnectionPool>();
+        reactor = std::make_unique<HttpReactor>(connectionPool.get());
+
+        // Connections to the previous server are useless now, warm up the new one
+        IPRepository::getInstance().getActiveServerChangedEvent()->subscribe([this](Domain::ServerIP server) {
+            connectionPool->clear();
+            preconnect();
+        });
     }
 
     NetworkClient::~NetworkClient() {
+        // Transfers and handles must be gone before curl is torn down
+        reactor.reset();
+        connectionPool.reset();
         curl_global_cleanup();
     }
 
-    std::string NetworkClient::getBaseUrl() {
-        auto server = IPRepository::getInstance().getActiveServer();
-        if (server.address.empty()) return "";
-        
-        // Ensure protocol
-        if (server.address.find("http") == std::string::npos) {
-            return "http://" + server.address + ":3000";
-        }
-        return server.address;
+    void NetworkClient::preconnect() {
+        const std::string& baseUrl = getBaseUrl();
+        if (baseUrl.empty()) return;
+
+        // A HEAD request leaves a live connection in the shared cache for the next transfer
+        HttpRequest request;
+        request.url = baseUrl + "/";
+        request.headOnly = true;
+        request.timeoutSec = 5;
+        reactor->submit(request, [baseUrl](HttpResponse& response) {
+            if (response.ok()) brls::Logger::info("Network: preconnected to {}", baseUrl);
+        });
     }
 
-    std::string NetworkClient::performGet(const std::string& url) {
-        CURL* curl;
-        CURLcode res;
-        std::string readBuffer;
-
-        curl = curl_easy_init();
-        if (curl) {
-            brls::Logger::info("Network: GET {}", url);
-            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L); // 10s timeout
-            
-            // Disable SSL verify for local servers if needed
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
-
-            res = curl_easy_perform(curl);
-            if (res != CURLE_OK) {
-                brls::Logger::error("Network: curl_easy_perform() failed: {}", curl_easy_strerror(res));
-                readBuffer = "";
-            }
-            curl_easy_cleanup(curl);
-        }
-        return readBuffer;
+    void NetworkClient::logStats() const {
+        HttpReactor::Stats stats = reactor->getStats();
+        brls::Logger::info("Network: {} requests ({} joined in-flight), {} transfers over {} connections ({} over HTTP/2), {} KiB received for {} KiB of content",
+            requestCount.load(), coalescedCount.load(), stats.transfers, stats.connections, stats.http2Transfers,
+            stats.wireBytes / 1024, stats.bodyBytes / 1024);
+    }
+
+    // Worker threads call this per request; the snapshot computed it once
+    const std::string& NetworkClient::getBaseUrl() {
+        if (!baseUrlOverride.empty()) return baseUrlOverride;
+        return IPRepository::getInstance().getConfig().baseUrl;
     }
 
-    void NetworkClient::getTrending(Callback cb, const std::string& pageToken) {
-        brls::async([this, cb, pageToken]() {
-            std::string baseUrl = getBaseUrl();
-            if (baseUrl.empty()) {
-                brls::sync([cb]() { cb({}, "", "No server configured"); });
+    void NetworkClient::post(std::function<void()> task) {
+        if (onResult) onResult();
+        brls::sync(task);
+    }
+
+    void NetworkClient::performGet(const std::string& url, HttpReactor::Completion done, PriorityFn priority, std::shared_ptr<BodySink> sink, CancelTokenPtr token) {
+        requestCount++;
+        std::shared_ptr<InFlight> entry;
+        {
+            // Identical request already running: wait for its result instead of downloading again.
+            // Waiters read the first caller's sink from the response; their own is never fed.
+            std::lock_guard<std::mutex> lock(inFlightMutex);
+            auto it = inFlight.find(url);
+            if (it != inFlight.end()) {
+                it->second->waiters.push_back({std::move(done), std::move(token), std::move(priority)});
+                coalescedCount++;
+                brls::Logger::debug("Network: joined in-flight {} ({} of {} requests saved)", url, coalescedCount.load(), requestCount.load());
                 return;
             }
+            entry = std::make_shared<InFlight>();
+            entry->waiters.push_back({std::move(done), std::move(token), std::move(priority)});
+            inFlight[url] = entry;
+        }
 
-            std::string url = baseUrl + "/api/trending?maxResults=20";
-            if (!pageToken.empty()) {
-                url += "&pageToken=" + pageToken;
+        HttpRequest request;
+        request.url = url;
+        request.sink = std::move(sink);
+        request.cancelled = [this, url, entry]() {
+            std::lock_guard<std::mutex> lock(inFlightMutex);
+            for (auto& waiter : entry->waiters) {
+                if (!waiter.token || !waiter.token->isCancelled()) return false;
             }
-
-            std::string response = performGet(url);
-            std::vector<Domain::VideoItem> videos;
-            std::string error = "";
-            std::string nextPageToken = "";
-
-            try {
-                if (response.empty()) throw std::runtime_error("Empty response");
-                
-                json j = json::parse(response);
-                nextPageToken = j.value("nextPageToken", "");
-
-                if (j.contains("videos")) {
-                    for (auto& item : j["videos"]) {
-                        Domain::VideoItem video;
-                        video.id = item.value("id", "");
-                        video.title = item.value("title", "No Title");
-                        video.author = item.value("channelTitle", "Unknown");
-                        
-                        if (item.contains("thumbnails") && item["thumbnails"].contains("medium")) {
-                            video.thumbnailUrlMedium = item["thumbnails"]["medium"].value("url", "");
-                        }
-                        
-                        video.views = item.contains("statistics") ? item["statistics"].value("viewCount", "0") : "0";
-                        video.date = item.value("publishedAt", "");
-                        
-                        videos.push_back(video);
-                    }
-                }
-            } catch (const std::exception& e) {
-                error = e.what();
-                brls::Logger::error("Network: getTrending failed: {}", error);
+            // Nobody wants the result any more; a new request for this URL starts its own transfer
+            auto it = inFlight.find(url);
+            if (it != inFlight.end() && it->second == entry) inFlight.erase(it);
+            return true;
+        };
+        request.priority = [this, entry]() {
+            // A Play that joined a thumbnail-level prefetch lifts the whole transfer
+            std::lock_guard<std::mutex> lock(inFlightMutex);
+            int best = RequestPriority::Thumbnail;
+            bool any = false;
+            for (auto& waiter : entry->waiters) {
+                if (waiter.token && waiter.token->isCancelled()) continue;
+                int p = waiter.priority();
+                if (!any || p < best) best = p;
+                any = true;
+            }
+            return best;
+        };
+        reactor->submit(request, [this, url, entry](HttpResponse& response) {
+            std::vector<Waiter> waiters;
+            {
+                std::lock_guard<std::mutex> lock(inFlightMutex);
+                waiters.swap(entry->waiters);
+                auto it = inFlight.find(url);
+                if (it != inFlight.end() && it->second == entry) inFlight.erase(it);
+            }
+            for (auto& waiter : waiters) {
+                if (waiter.token && waiter.token->isCancelled()) continue;
+                waiter.done(response);
             }
-
-            brls::sync([cb, videos, nextPageToken, error]() { cb(videos, nextPageToken, error); });
         });
     }
 
-    void NetworkClient::search(const std::string& query, Callback cb, const std::string& pageToken) {
-        brls::async([this, query, cb, pageToken]() {
-            std::string baseUrl = getBaseUrl();
-            if (baseUrl.empty()) {
-                brls::sync([cb]() { cb({}, "", "No server configured"); });
+    void NetworkClient::cancel(const CancelTokenPtr& token) {
+        if (!token) return;
+        token->cancel();
+        reactor->wakeup();
+    }
+
+    // Transport failure, malformed JSON or an error payload, in that order
+    static std::string finishParse(HttpResponse& response, JsonBodyParser* parser) {
+        // A parse error aborts the transfer with CURLE_WRITE_ERROR; the parser knows why
+        if (!response.ok() && response.code != CURLE_WRITE_ERROR) return response.error();
+        if (!parser->finish()) return parser->getError();
+        return "";
+    }
+
+    void NetworkClient::getFeed(const std::string& url, FeedParser::Kind kind, Callback cb, ItemsCallback onItems, CancelTokenPtr token) {
+        if (token) {
+            // The result may already be queued for the main thread when the caller cancels
+            cb = [cb, token](const std::vector<Domain::VideoRef>& videos, const std::string& nextPageToken, const std::string& error) {
+                if (!token->isCancelled()) cb(videos, nextPageToken, error);
+            };
+        }
+
+        FeedParser::BatchCallback onBatch = nullptr;
+        if (onItems) {
+            // Complete rows go to the UI while the rest of the page is still downloading
+            onBatch = [this, onItems, token](const std::vector<Domain::VideoRef>& videos) {
+                if (token && token->isCancelled()) return;
+                post([onItems, videos, token]() {
+                    if (!token || !token->isCancelled()) onItems(videos);
+                });
+            };
+        }
+
+        performGet(url, [this, cb](HttpResponse& response) {
+            auto* parser = static_cast<FeedParser*>(response.sink.get());
+            std::string error = finishParse(response, parser);
+            if (!error.empty()) {
+                brls::Logger::error("Network: feed request failed: {}", error);
+                post([cb, error]() { cb({}, "", error); });
                 return;
             }
 
-            char* encoded = curl_easy_escape(nullptr, query.c_str(), query.length());
-            std::string url = baseUrl + "/api/search?q=" + std::string(encoded) + "&maxResults=20&type=video";
-            curl_free(encoded);
+            std::vector<Domain::VideoRef> videos = parser->videos;
+            std::string nextPageToken = parser->nextPageToken;
+            post([cb, videos, nextPageToken]() { cb(videos, nextPageToken, ""); });
+        }, [] { return RequestPriority::Page; }, std::make_shared<FeedParser>(kind, onBatch), token);
+    }
+
+    void NetworkClient::getTrending(Callback cb, const std::string& pageToken, ItemsCallback onItems, CancelTokenPtr token) {
+        const std::string& baseUrl = getBaseUrl();
+        if (baseUrl.empty()) {
+            post([cb]() { cb({}, "", "No server configured"); });
+            return;
+        }
 
-            if (!pageToken.empty()) {
-                url += "&pageToken=" + pageToken;
-            }
+        std::string url = baseUrl + "/api/trending?maxResults=20";
+        if (!pageToken.empty()) {
+            url += "&pageToken=" + pageToken;
+        }
 
-            std::string response = performGet(url);
-            std::vector<Domain::VideoItem> videos;
-            std::string error = "";
-            std::string nextPageToken = "";
-
-            try {
-                if (response.empty()) throw std::runtime_error("Empty response");
-                
-                json j = json::parse(response);
-                nextPageToken = j.value("nextPageToken", "");
-
-                if (j.contains("videos")) {
-                    for (auto& item : j["videos"]) {
-                        std::string id = item.value("id", "");
-                        if (id.empty()) continue;
-
-                        Domain::VideoItem video;
-                        video.id = id;
-                        video.title = item.value("title", "No Title");
-                        
-                        // New model: channel is an object with "name"
-                        if (item.contains("channel")) {
-                            video.author = item["channel"].value("name", "Unknown");
-                        } else {
-                            video.author = item.value("channelTitle", "Unknown");
-                        }
-                        
-                        if (item.contains("thumbnails") && item["thumbnails"].contains("medium")) {
-                            video.thumbnailUrlMedium = item["thumbnails"]["medium"].value("url", "");
-                        }
-                        
-                        video.date = item.value("publishedAt", "");
-                        video.views = "SEARCH_HIDDEN"; // Marker to hide views in HomeActivity
-                        videos.push_back(video);
-                    }
-                }
-            } catch (const std::exception& e) {
-                error = e.what();
-            }
+        getFeed(url, FeedParser::Kind::Trending, cb, onItems, token);
+    }
 
-            brls::sync([cb, videos, nextPageToken, error]() { cb(videos, nextPageToken, error); });
-        });
+    void NetworkClient::search(const std::string& query, Callback cb, const std::string& pageToken, ItemsCallback onItems, CancelTokenPtr token) {
+        const std::string& baseUrl = getBaseUrl();
+        if (baseUrl.empty()) {
+            post([cb]() { cb({}, "", "No server configured"); });
+            return;
+        }
+
+        char* encoded = curl_easy_escape(nullptr, query.c_str(), query.length());
+        std::string url = baseUrl + "/api/search?q=" + std::string(encoded) + "&maxResults=20&type=video";
+        curl_free(encoded);
+
+        if (!pageToken.empty()) {
+            url += "&pageToken=" + pageToken;
+        }
+
+        getFeed(url, FeedParser::Kind::Search, cb, onItems, token);
     }
 
-    void NetworkClient::getStream(const std::string& videoId, StreamCallback cb) {
-        brls::async([this, videoId, cb]() {
-            std::string baseUrl = getBaseUrl();
-            if (baseUrl.empty()) {
-                brls::sync([cb]() { cb({}, "No server configured"); });
-                return;
-            }
+    void NetworkClient::getStream(const std::string& videoId, StreamCallback cb, CancelTokenPtr token) {
+        requestStream(videoId, cb, token, RequestPriority::Stream);
+    }
 
-            std::string response = performGet(baseUrl + "/api/stream?id=" + videoId);
+    void NetworkClient::requestStream(const std::string& videoId, StreamCallback cb, CancelTokenPtr token, int priority) {
+        if (token) {
+            cb = [cb, token](const Domain::StreamInfo& info, const std::string& error) {
+                if (!token->isCancelled()) cb(info, error);
+            };
+        }
+
+        Domain::StreamInfo cached;
+        if (streamCache.get(videoId, cached)) {
+            brls::Logger::debug("Network: stream {} served from cache", videoId);
+            post([cb, cached]() { cb(cached, ""); });
+            return;
+        }
+
+        const std::string& baseUrl = getBaseUrl();
+        if (baseUrl.empty()) {
+            post([cb]() { cb({}, "No server configured"); });
+            return;
+        }
+
+        performGet(baseUrl + "/api/stream?id=" + videoId, [this, videoId, cb](HttpResponse& response) {
+            auto* parser = static_cast<StreamInfoParser*>(response.sink.get());
+            std::string error = finishParse(response, parser);
             Domain::StreamInfo streamInfo;
-            std::string error = "";
-
-            try {
-                if (response.empty()) throw std::runtime_error("Empty response");
-                
-                json j = json::parse(response);
-                if (j.contains("url")) {
-                    streamInfo.url = j.value("url", "");
-                    streamInfo.title = j.value("title", "");
-                    streamInfo.thumbnailUrl = j.value("thumbnail", "");
-                    streamInfo.duration = j.value("duration", 0);
-
-                    if (j.contains("formats")) {
-                        if (j["formats"].is_array()) {
-                            for (auto& f : j["formats"]) {
-                                Domain::StreamFormat format;
-                                format.formatId = f.value("format_id", "");
-                                format.resolution = f.value("resolution", "");
-                                format.url = f.value("url", "");
-                                format.proxyUrl = f.value("proxyUrl", "");
-                                format.quality = f.value("quality", "");
-                                format.type = "muxed";
-                                streamInfo.formats.push_back(format);
-                            }
-                        } else if (j["formats"].is_object()) {
-                            auto formatsObj = j["formats"];
-                            
-                            if (formatsObj.contains("audioOnly") && formatsObj["audioOnly"].is_array() && !formatsObj["audioOnly"].empty()) {
-                                streamInfo.audioUrl = formatsObj["audioOnly"][0].value("url", "");
-                                streamInfo.audioProxyUrl = formatsObj["audioOnly"][0].value("proxyUrl", "");
-                            }
-                            
-                            if (formatsObj.contains("muxed") && formatsObj["muxed"].is_array()) {
-                                for (auto& f : formatsObj["muxed"]) {
-                                    Domain::StreamFormat format;
-                                    format.formatId = f.value("format_id", "");
-                                    format.resolution = f.value("resolution", "");
-                                    format.url = f.value("url", "");
-                                    format.proxyUrl = f.value("proxyUrl", "");
-                                    format.quality = f.value("quality", "");
-                                    format.type = "muxed";
-                                    streamInfo.formats.push_back(format);
-                                }
-                                // Use first muxed format's proxyUrl as default
-                                if (!formatsObj["muxed"].empty()) {
-                                    streamInfo.proxyUrl = formatsObj["muxed"][0].value("proxyUrl", "");
-                                }
-                            }
-                            
-                            if (formatsObj.contains("videoOnly") && formatsObj["videoOnly"].is_array()) {
-                                for (auto& f : formatsObj["videoOnly"]) {
-                                    Domain::StreamFormat format;
-                                    format.formatId = f.value("format_id", "");
-                                    format.resolution = f.value("resolution", "");
-                                    format.url = f.value("url", "");
-                                    format.proxyUrl = f.value("proxyUrl", "");
-                                    format.quality = f.value("quality", "");
-                                    format.type = "videoOnly";
-                                    streamInfo.formats.push_back(format);
-                                }
-                            }
-                        }
-                    }
-                } else if (j.contains("error")) {
-                    error = j["error"];
-                } else {
-                    error = "Unknown error extracting stream";
-                }
-            } catch (const std::exception& e) {
-                error = e.what();
+            if (error.empty()) {
+                streamInfo = parser->info;
+                streamCache.put(videoId, streamInfo);
             }
 
-            brls::sync([cb, streamInfo, error]() { cb(streamInfo, error); });
-        });
+            post([cb, streamInfo, error]() { cb(streamInfo, error); });
+        }, [priority] { return priority; }, std::make_shared<StreamInfoParser>(), token);
     }
 
-    void NetworkClient::fetchImage(const std::string& url, std::function<void(const unsigned char* data, size_t size)> cb) {
-        brls::async([this, url, cb]() {
-            std::string response = performGet(url);
-            if (!response.empty()) {
-                // Return data to main thread
-                // Copy data to a vector to safely pass it
-                std::vector<unsigned char> data(response.begin(), response.end());
-                brls::sync([cb, data]() {
-                    cb(data.data(), data.size());
-                });
+    void NetworkClient::prefetchStream(const std::string& videoId) {
+        if (videoId.empty() || streamCache.contains(videoId)) return;
+
+        // A real getStream for the same video joins this transfer if it is still running
+        requestStream(videoId, [](const Domain::StreamInfo& info, const std::string& error) {}, nullptr, RequestPriority::Prefetch);
+    }
+
+    bool NetworkClient::getCachedStream(const std::string& videoId, Domain::StreamInfo& info) {
+        return streamCache.get(videoId, info);
+    }
+
+    void NetworkClient::fetchImage(const std::string& url, std::function<void(const std::string& data)> cb, CancelTokenPtr token, PriorityFn priority) {
+        if (!priority) priority = [] { return RequestPriority::Thumbnail; };
+        performGet(url, [this, cb](HttpResponse& response) {
+            // Decoding is left to the caller, still off the main thread. An error page is no image.
+            if (response.ok() && response.status < 400) {
+                cb(response.body);
             } else {
-                brls::sync([cb]() { cb(nullptr, 0); });
+                cb("");
             }
-        });
+        }, priority, nullptr, token);
     }
 
 } // namespace Data
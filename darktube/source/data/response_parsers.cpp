@@ -0,0 +1,264 @@
+#include "../include/data/response_parsers.hpp"
+#include <cstdlib>
+
+namespace DarkTube {
+namespace Data {
+
+    bool JsonBodyParser::finish() {
+        if (finished) return error.empty();
+        finished = true;
+
+        if (parser.getBytesParsed() == 0) {
+            error = "Empty response";
+        } else if (!parser.finish()) {
+            error = parser.getError();
+        } else {
+            complete();
+        }
+        return error.empty();
+    }
+
+    // --- FeedParser ---
+
+    bool FeedParser::key(std::string& name) {
+        bool wanted = false;
+        switch (path.size()) {
+            case 1:
+                wanted = name == "nextPageToken" || name == "videos";
+                break;
+            case 3:
+                if (!inVideo()) break;
+                wanted = name == "id" || name == "title" || name == "channelTitle" || name == "publishedAt" || name == "thumbnails" ||
+                         (kind == Kind::Search && name == "channel") ||
+                         (kind == Kind::Trending && name == "statistics");
+                break;
+            case 4:
+                if (!inVideo()) break;
+                wanted = (path[2] == "channel" && name == "name") ||
+                         (path[2] == "statistics" && name == "viewCount") ||
+                         (path[2] == "thumbnails" && name == "medium");
+                break;
+            case 5:
+                wanted = inVideo() && path[2] == "thumbnails" && path[3] == "medium" && name == "url";
+                break;
+        }
+
+        // Everything else (descriptions, other thumbnail sizes, ...) is never buffered
+        if (wanted) path.back() = name;
+        return wanted;
+    }
+
+    void FeedParser::string(std::string& value) {
+        if (path.size() == 1) {
+            if (path[0] == "nextPageToken") nextPageToken = std::move(value);
+            return;
+        }
+        if (!inVideo()) return;
+
+        const std::string& field = path.back();
+        if (path.size() == 3) {
+            if (field == "id") {
+                video.id = value;
+            } else if (field == "title") {
+                video.title = value;
+                hasTitle = true;
+            } else if (field == "channelTitle") {
+                channelTitle = value;
+                hasChannelTitle = true;
+            } else if (field == "publishedAt") {
+                video.date = value;
+            }
+        } else if (path.size() == 4) {
+            if (path[2] == "channel") {
+                channelName = value;
+                hasChannelName = true;
+            } else if (path[2] == "statistics") {
+                video.views = value;
+                hasViews = true;
+            }
+        } else if (path.size() == 5) {
+            video.thumbnailUrlMedium = value;
+        }
+    }
+
+    void FeedParser::number(const std::string& text) {
+        // Some backends send viewCount as a number
+        if (path.size() == 4 && inVideo() && path[2] == "statistics") {
+            video.views = text;
+            hasViews = true;
+        }
+    }
+
+    void FeedParser::startObject() {
+        if (path.size() == 2 && path[0] == "videos" && path[1].empty()) {
+            video.id.clear();
+            video.title.clear();
+            video.thumbnailUrlMedium.clear();
+            video.views.clear();
+            video.date.clear();
+            hasTitle = hasChannel = hasChannelName = hasChannelTitle = hasViews = false;
+        } else if (path.size() == 3 && inVideo() && path[2] == "channel") {
+            hasChannel = true;
+        }
+        path.emplace_back();
+    }
+
+    void FeedParser::endObject() {
+        if (path.size() == 3 && inVideo()) endVideo();
+        path.pop_back();
+    }
+
+    void FeedParser::startArray() {
+        path.emplace_back();
+    }
+
+    void FeedParser::endArray() {
+        path.pop_back();
+    }
+
+    void FeedParser::endVideo() {
+        if (kind == Kind::Search && video.id.empty()) return;
+
+        if (!hasTitle) video.title = "No Title";
+        if (kind == Kind::Search) {
+            // New model: channel is an object with "name"
+            if (hasChannel) {
+                video.author = hasChannelName ? channelName : "Unknown";
+            } else {
+                video.author = hasChannelTitle ? channelTitle : "Unknown";
+            }
+            video.views = "SEARCH_HIDDEN"; // Marker to hide views in HomeActivity
+        } else {
+            video.author = hasChannelTitle ? channelTitle : "Unknown";
+            if (!hasViews) video.views = "0";
+        }
+        videos.emplace_back(page, page->add(video));
+
+        if (onBatch && videos.size() - batched >= BatchSize) {
+            onBatch(std::vector<Domain::VideoRef>(videos.begin() + batched, videos.end()));
+            batched = videos.size();
+        }
+    }
+
+    // --- StreamInfoParser ---
+
+    bool StreamInfoParser::inFormat() const {
+        if (path.empty() || path[0] != "formats") return false;
+        if (path.size() == 3) return path[1].empty();                      // formats: [ {...} ]
+        if (path.size() == 4) return !path[1].empty() && path[2].empty();  // formats: { muxed: [ {...} ] }
+        return false;
+    }
+
+    bool StreamInfoParser::key(std::string& name) {
+        bool wanted = false;
+        if (path.size() == 1) {
+            wanted = name == "url" || name == "title" || name == "thumbnail" || name == "duration" || name == "error" || name == "formats";
+        } else if (path.size() == 2 && path[0] == "formats") {
+            wanted = name == "audioOnly" || name == "muxed" || name == "videoOnly";
+        } else if (inFormat()) {
+            wanted = name == "format_id" || name == "resolution" || name == "url" || name == "proxyUrl" || name == "quality" || name == "tbr";
+        }
+
+        if (wanted) path.back() = name;
+        return wanted;
+    }
+
+    void StreamInfoParser::string(std::string& value) {
+        if (path.size() == 1) {
+            const std::string& field = path[0];
+            if (field == "url") {
+                info.url = std::move(value);
+                hasUrl = true;
+            } else if (field == "title") {
+                info.title = std::move(value);
+            } else if (field == "thumbnail") {
+                info.thumbnailUrl = std::move(value);
+            } else if (field == "error") {
+                serverError = std::move(value);
+                hasError = true;
+            }
+            return;
+        }
+        if (!inFormat()) return;
+
+        const std::string& field = path.back();
+        if (field == "format_id") {
+            format.formatId = std::move(value);
+        } else if (field == "resolution") {
+            format.resolution = std::move(value);
+        } else if (field == "url") {
+            format.url = std::move(value);
+        } else if (field == "proxyUrl") {
+            format.proxyUrl = std::move(value);
+        } else if (field == "quality") {
+            format.quality = std::move(value);
+        }
+    }
+
+    void StreamInfoParser::number(const std::string& text) {
+        if (path.size() == 1 && path[0] == "duration") {
+            info.duration = (int)strtod(text.c_str(), nullptr);
+        } else if (inFormat() && path.back() == "tbr") {
+            format.bitrateKbps = strtod(text.c_str(), nullptr);
+        }
+    }
+
+    void StreamInfoParser::startObject() {
+        path.emplace_back();
+        if (inFormat()) format = Domain::StreamFormat();
+    }
+
+    void StreamInfoParser::endObject() {
+        if (inFormat()) endFormat();
+        path.pop_back();
+    }
+
+    void StreamInfoParser::startArray() {
+        path.emplace_back();
+        if (path[0] == "formats" && path.size() <= 3) formatIndex = 0;
+    }
+
+    void StreamInfoParser::endArray() {
+        path.pop_back();
+    }
+
+    void StreamInfoParser::endFormat() {
+        bool first = formatIndex++ == 0;
+
+        if (path.size() == 3) {
+            format.type = "muxed";
+            muxed.push_back(std::move(format));
+            return;
+        }
+
+        const std::string& group = path[1];
+        if (group == "audioOnly") {
+            if (first) {
+                info.audioUrl = std::move(format.url);
+                info.audioProxyUrl = std::move(format.proxyUrl);
+            }
+        } else if (group == "muxed") {
+            // Use first muxed format's proxyUrl as default
+            if (first) info.proxyUrl = format.proxyUrl;
+            format.type = "muxed";
+            muxed.push_back(std::move(format));
+        } else if (group == "videoOnly") {
+            format.type = "videoOnly";
+            videoOnly.push_back(std::move(format));
+        }
+    }
+
+    void StreamInfoParser::complete() {
+        if (!hasUrl) {
+            info = Domain::StreamInfo();
+            error = hasError ? serverError : "Unknown error extracting stream";
+            return;
+        }
+
+        // Muxed first, then video-only, whatever order the server sent them in
+        info.formats = std::move(muxed);
+        for (auto& f : videoOnly) info.formats.push_back(std::move(f));
+    }
+
+} // namespace Data
+} // namespace DarkTube
@@ -0,0 +1,69 @@
+#include "../include/data/stream_cache.hpp"
+#include <cstdlib>
+#include <algorithm>
+
+namespace DarkTube {
+namespace Data {
+
+    static time_t parseExpire(const std::string& url) {
+        size_t pos = url.find("expire=");
+        if (pos == std::string::npos) return 0;
+        // Only accept it as a query parameter, not as part of another name
+        if (pos > 0 && url[pos - 1] != '?' && url[pos - 1] != '&' && url[pos - 1] != '/') return 0;
+        return (time_t)strtoll(url.c_str() + pos + 7, nullptr, 10);
+    }
+
+    time_t StreamCache::expiryOf(const Domain::StreamInfo& info) {
+        time_t expiry = 0;
+        auto consider = [&expiry](const std::string& url) {
+            time_t e = parseExpire(url);
+            if (e > 0 && (expiry == 0 || e < expiry)) expiry = e;
+        };
+
+        consider(info.url);
+        consider(info.audioUrl);
+        for (const auto& format : info.formats) {
+            consider(format.url);
+        }
+
+        if (expiry == 0) expiry = time(nullptr) + DefaultTtl;
+        return expiry;
+    }
+
+    std::list<StreamCache::Entry>::iterator StreamCache::find(const std::string& videoId, time_t now) {
+        auto it = std::find_if(entries.begin(), entries.end(), [&videoId](const Entry& e) { return e.videoId == videoId; });
+        if (it != entries.end() && it->expiresAt - ExpiryMargin <= now) {
+            entries.erase(it);
+            return entries.end();
+        }
+        return it;
+    }
+
+    bool StreamCache::get(const std::string& videoId, Domain::StreamInfo& info) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = find(videoId, time(nullptr));
+        if (it == entries.end()) return false;
+
+        entries.splice(entries.begin(), entries, it);
+        info = it->info;
+        return true;
+    }
+
+    bool StreamCache::contains(const std::string& videoId) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return find(videoId, time(nullptr)) != entries.end();
+    }
+
+    void StreamCache::put(const std::string& videoId, const Domain::StreamInfo& info) {
+        time_t expiresAt = expiryOf(info);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = find(videoId, time(nullptr));
+        if (it != entries.end()) entries.erase(it);
+
+        entries.push_front({videoId, info, expiresAt});
+        if (entries.size() > capacity) entries.pop_back();
+    }
+
+} // namespace Data
+} // namespace DarkTube
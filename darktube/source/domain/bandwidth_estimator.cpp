@@ -0,0 +1,37 @@
+#include "../include/domain/bandwidth_estimator.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace DarkTube {
+namespace Domain {
+
+    void BandwidthEstimator::Average::add(double weight, double value) {
+        double alpha = std::pow(0.5, weight / halfLife);
+        estimate = value * (1 - alpha) + alpha * estimate;
+        totalWeight += weight;
+    }
+
+    // Undoes the bias towards the initial 0 while few samples have been seen
+    double BandwidthEstimator::Average::get() const {
+        double zeroFactor = 1 - std::pow(0.5, totalWeight / halfLife);
+        return zeroFactor > 0 ? estimate / zeroFactor : 0;
+    }
+
+    void BandwidthEstimator::addSample(double bytes, double seconds) {
+        if (bytes <= 0 || seconds <= 0) return;
+
+        double kbps = bytes * 8 / 1000 / seconds;
+        std::lock_guard<std::mutex> lock(mutex);
+        fast.add(seconds, kbps);
+        slow.add(seconds, kbps);
+        totalBytes += bytes;
+    }
+
+    double BandwidthEstimator::getEstimateKbps() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (totalBytes < MinTotalBytes) return 0;
+        return std::min(fast.get(), slow.get());
+    }
+
+} // namespace Domain
+} // namespace DarkTube
@@ -0,0 +1,51 @@
+#include "../include/domain/cache_profile.hpp"
+#include <algorithm>
+
+namespace DarkTube {
+namespace Domain {
+
+    // Share of the free memory the cache may take, and bounds on what that comes to
+    static constexpr double MemoryShare = 0.125;
+    static constexpr uint64_t MinBytes = 8 * CacheProfile::MiB;
+    static constexpr uint64_t MaxMemoryBytes = 256 * CacheProfile::MiB;
+    static constexpr uint64_t ConstrainedBytes = 32 * CacheProfile::MiB;
+    // Read-ahead worth buffering; beyond it memory buys nothing but faster seeks
+    static constexpr double ReadaheadSec = 120;
+    // Videos at least this long may use the disk cache, which holds this much
+    static constexpr double LongVideoSec = 20 * 60;
+    static constexpr uint64_t DiskBytes = 1024 * CacheProfile::MiB;
+    static constexpr double DiskReadaheadSec = 600;
+
+    CacheProfile CacheProfile::choose(uint64_t availableBytes, double kbps, double durationSec, bool diskCache) {
+        CacheProfile profile;
+        double bytesPerSec = kbps * 1000 / 8;
+        // Caching more than the whole video is pointless
+        double videoBytes = bytesPerSec > 0 && durationSec > 0 ? bytesPerSec * durationSec * 1.1 : 0;
+
+        if (diskCache && durationSec >= LongVideoSec) {
+            double forward = bytesPerSec > 0 ? bytesPerSec * DiskReadaheadSec : DiskBytes / 2;
+            if (videoBytes > 0) forward = std::min(forward, videoBytes);
+            profile.name = "disk";
+            profile.onDisk = true;
+            profile.maxBytes = std::clamp((uint64_t)forward, MinBytes, DiskBytes / 2);
+            profile.maxBackBytes = videoBytes > 0 ? std::min((uint64_t)videoBytes, DiskBytes / 2) : DiskBytes / 2;
+            return profile;
+        }
+        if (availableBytes == 0) return profile;
+
+        uint64_t budget = std::clamp((uint64_t)(availableBytes * MemoryShare), MinBytes, MaxMemoryBytes);
+        double wanted = bytesPerSec > 0 ? bytesPerSec * ReadaheadSec : budget;
+        if (videoBytes > 0) wanted = std::min(wanted, videoBytes);
+
+        // Three quarters ahead, the rest (at most half the read-ahead) behind. Near the
+        // budget floor three quarters is below MinBytes; the budget wins over the floor.
+        profile.name = budget <= ConstrainedBytes ? "constrained" : budget < MaxMemoryBytes ? "standard" : "large";
+        uint64_t forwardMax = budget * 3 / 4;
+        profile.maxBytes = std::max(std::min(MinBytes, forwardMax), std::min((uint64_t)wanted, forwardMax));
+        uint64_t backLeft = budget - profile.maxBytes;
+        profile.maxBackBytes = std::min(backLeft, std::max(MinBytes / 4, profile.maxBytes / 2));
+        return profile;
+    }
+
+} // namespace Domain
+} // namespace DarkTube
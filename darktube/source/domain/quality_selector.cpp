@@ -0,0 +1,74 @@
+#include "../include/domain/quality_selector.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace DarkTube {
+namespace Domain {
+
+    // Rough bitrate of an H.264 stream by frame height, for formats without "tbr"
+    static double guessKbps(int height) {
+        if (height <= 0) return 1000;
+        return height * height * 0.005;
+    }
+
+    QualitySelector::QualitySelector(const std::vector<StreamFormat>& formats, int maxHeight) {
+        for (size_t i = 0; i < formats.size(); i++) {
+            const StreamFormat& format = formats[i];
+            if (format.url.empty() && format.proxyUrl.empty()) continue;
+            int height = heightOf(format);
+            if (maxHeight > 0 && height > maxHeight) continue;
+
+            double kbps = format.bitrateKbps > 0 ? format.bitrateKbps : guessKbps(height);
+            if (format.type == "videoOnly") kbps += AudioKbps;
+            ladder.push_back({i, kbps});
+        }
+        std::stable_sort(ladder.begin(), ladder.end(), [](const Rung& a, const Rung& b) { return a.kbps < b.kbps; });
+    }
+
+    int QualitySelector::rungOf(size_t format) const {
+        for (size_t rung = 0; rung < ladder.size(); rung++) {
+            if (ladder[rung].format == format) return (int)rung;
+        }
+        return -1;
+    }
+
+    size_t QualitySelector::pickForBandwidth(double kbps) const {
+        size_t best = 0;
+        for (size_t rung = 0; rung < ladder.size(); rung++) {
+            if (ladder[rung].kbps <= kbps * Headroom) best = rung;
+        }
+        return best;
+    }
+
+    size_t QualitySelector::next(size_t current, double kbps, double bufferSec, bool rebuffering) const {
+        if (current >= ladder.size()) return current;
+        double budget = kbps * Headroom;
+
+        // A low buffer alone is normal right after a start or seek; it only means trouble
+        // when the format is more than the estimate can carry. Without an estimate, only
+        // an actual stall counts.
+        bool starving = bufferSec < LowBufferSec && kbps > 0 && ladder[current].kbps > budget;
+        if (rebuffering || starving) {
+            size_t target = kbps > 0 ? pickForBandwidth(kbps) : current;
+            // Stalled although the estimate says it fits: step down anyway
+            if (target >= current) target = current > 0 ? current - 1 : 0;
+            return target;
+        }
+
+        if (bufferSec >= HighBufferSec && current + 1 < ladder.size() && ladder[current + 1].kbps <= budget) {
+            return current + 1;
+        }
+        return current;
+    }
+
+    int QualitySelector::heightOf(const StreamFormat& format) {
+        size_t x = format.resolution.find('x');
+        if (x != std::string::npos) {
+            int height = atoi(format.resolution.c_str() + x + 1);
+            if (height > 0) return height;
+        }
+        return atoi(format.quality.c_str()); // "720p" -> 720, "medium" -> 0
+    }
+
+} // namespace Domain
+} // namespace DarkTube
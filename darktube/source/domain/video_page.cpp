@@ -0,0 +1,56 @@
+#include "../include/domain/video_page.hpp"
+#include <cstring>
+#include <new>
+
+namespace DarkTube {
+namespace Domain {
+
+    void* VideoPage::allocate(size_t size, size_t align) {
+        // Oversized values (a huge title, say) get a block of their own, kept behind
+        // the block that is currently being filled
+        if (size > BlockSize / 4) {
+            auto at = blocks.empty() ? blocks.end() : blocks.end() - 1;
+            char* data = blocks.emplace(at, new char[size])->get();
+            arenaBytes += size;
+            return data;
+        }
+
+        size_t offset = (used + align - 1) & ~(align - 1);
+        if (offset + size > BlockSize) {
+            blocks.emplace_back(new char[BlockSize]);
+            arenaBytes += BlockSize;
+            offset = 0;
+        }
+        used = offset + size;
+        return blocks.back().get() + offset;
+    }
+
+    std::string_view VideoPage::store(const std::string& value) {
+        if (value.empty()) return {};
+        char* data = (char*)allocate(value.size(), 1);
+        memcpy(data, value.data(), value.size());
+        return std::string_view(data, value.size());
+    }
+
+    std::string_view VideoPage::intern(const std::string& value) {
+        auto it = authors.find(value);
+        if (it != authors.end()) return *it;
+
+        std::string_view stored = store(value);
+        authors.insert(stored);
+        return stored;
+    }
+
+    const VideoEntry* VideoPage::add(const VideoItem& video) {
+        VideoEntry* entry = new (allocate(sizeof(VideoEntry), alignof(VideoEntry))) VideoEntry();
+        entry->id = store(video.id);
+        entry->title = store(video.title);
+        entry->author = intern(video.author);
+        entry->thumbnailUrlMedium = store(video.thumbnailUrlMedium);
+        entry->views = store(video.views);
+        entry->date = store(video.date);
+        return entry;
+    }
+
+} // namespace Domain
+} // namespace DarkTube
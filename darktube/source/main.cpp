@@ -11,10 +11,14 @@
 #endif
 
 #include "view/mpv_core.hpp"
+#include "view/thumbnail_loader.hpp"
+#include "view/frame_profiler.hpp"
+#include "view/frame_pacer.hpp"
 #include "../include/core/theme.hpp"
 #include "../include/presentation/server_list_activity.hpp"
 #include "../include/presentation/home_activity.hpp"
 #include "../include/data/ip_repository.hpp"
+#include "../include/data/network_client.hpp"
 
 int main(int argc, char* argv[]) {
     // Redirect stdout and stderr to a file on the SD card so we can read it after crash
@@ -52,13 +56,41 @@ int main(int argc, char* argv[]) {
         DarkTube::Data::IPRepository::getInstance().setActiveServer(servers.front());
     }
 
+    FramePacer::instance().setEnabled(DarkTube::Data::IPRepository::getInstance().getPowerSaving());
+    // Pages and streams land on screen through brls::sync; don't hold their frame back.
+    // Set before the first request, since the network thread reads it unlocked.
+    DarkTube::Data::NetworkClient::instance().setOnResult([] { FramePacer::instance().wake(); });
+
+    // Open the server connection while the first activity is being built
+    DarkTube::Data::NetworkClient::instance().preconnect();
+
     brls::Application::pushActivity(new DarkTube::Presentation::HomeActivity());
     brls::Logger::info("DarkTube: HomeActivity pushed");
 
-    // Main loop
-    while (brls::Application::mainLoop()) {
+    // Main loop. Sync callbacks are drained here first so the profiler can time them;
+    // mainLoop drains whatever arrives in between itself.
+    FrameProfiler& profiler = FrameProfiler::instance();
+    while (true) {
+        profiler.beginFrame();
+        {
+            FrameProfiler::Scope scope(FrameProfiler::Idle);
+            FramePacer::instance().pace();
+        }
+        {
+            FrameProfiler::Scope scope(FrameProfiler::Sync);
+            brls::Threading::performSyncTasks();
+        }
+        bool running = brls::Application::mainLoop();
+        {
+            FrameProfiler::Scope scope(FrameProfiler::Uploads);
+            ThumbnailLoader::instance().processUploads();
+        }
+        profiler.endFrame();
+        if (!running) break;
     }
 
+    // Settings changed just before quitting may still be waiting out the save delay
+    DarkTube::Data::IPRepository::getInstance().flush();
     brls::Logger::info("DarkTube: Clean exit");
 
     return EXIT_SUCCESS;
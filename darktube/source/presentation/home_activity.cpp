@@ -5,7 +5,13 @@
 #include "../include/data/ip_repository.hpp"
 #include "../include/data/network_client.hpp"
 #include <borealis.hpp>
+#include <algorithm>
 #include "../include/presentation/ui_utils.hpp"
+#include "../include/presentation/video_grid.hpp"
+#include "view/texture_cache.hpp"
+#include "view/profiled_box.hpp"
+#include "view/frame_profiler.hpp"
+#include "view/frame_pacer.hpp"
 
 using namespace brls::literals;
 #define _(x) brls::getStr(x)
@@ -51,6 +57,9 @@ namespace Presentation {
     HomeActivity::~HomeActivity() {
         brls::Logger::info("HomeActivity destroyed");
         *aliveFlag = false; // Invalidate all async callbacks
+        Data::NetworkClient::instance().cancel(feedToken);
+        TextureCache::instance().logStats();
+        Data::NetworkClient::instance().logStats();
     }
 
     bool HomeActivity::isServerEmpty() {
@@ -58,7 +67,7 @@ namespace Presentation {
     }
 
     brls::View* HomeActivity::createContentView() {
-        brls::Box* root = new brls::Box();
+        brls::Box* root = new ProfiledBox();
         root->setAxis(brls::Axis::COLUMN);
         root->setWidthPercentage(100);
         root->setHeightPercentage(100);
@@ -86,6 +95,7 @@ namespace Presentation {
 
         // Global actions for this screen to toggle sidebar
         root->registerAction(_("main/toggle_sidebar"), brls::BUTTON_B, [this](brls::View* view) {
+            FrameProfiler::instance().markInput();
             this->toggleSidebar();
             return true;
         });
@@ -190,17 +200,14 @@ namespace Presentation {
             header->addView(ipLabel);
             content->addView(header);
 
-            // Scrolling Grid area
-            this->gridContainer = new brls::ScrollingFrame();
-            this->gridContainer->setGrow(1.0f);
-            
+            // Grid area (the recycler inside scrolls, the loading indicator sits below it)
             this->gridWrapper = new brls::Box();
             this->gridWrapper->setAxis(brls::Axis::COLUMN);
+            this->gridWrapper->setGrow(1.0f);
 
             this->gridWrapper->addView(createCategoryRow(currentTitle, currentVideos));
 
-            this->gridContainer->setContentView(this->gridWrapper);
-            content->addView(this->gridContainer);
+            content->addView(this->gridWrapper);
         }
 
         return content;
@@ -250,7 +257,7 @@ namespace Presentation {
         return state;
     }
 
-    brls::Box* HomeActivity::createCategoryRow(const std::string& title, const std::vector<Domain::VideoItem>& videos) {
+    brls::Box* HomeActivity::createCategoryRow(const std::string& title, const std::vector<Domain::VideoRef>& videos) {
         brls::Box* section = new brls::Box();
         section->setAxis(brls::Axis::COLUMN);
         section->setMarginBottom(40);
@@ -271,113 +278,22 @@ namespace Presentation {
             }
             section->addView(loadingRow);
         } else {
-            brls::Box* currentRow = nullptr;
-            for (size_t i = 0; i < videos.size(); ++i) {
-                // Create a new row every 4 items
-                if (i % 4 == 0) {
-                    currentRow = new brls::Box();
-                    currentRow->setAxis(brls::Axis::ROW);
-                    section->addView(currentRow);
-                }
-
-                const auto& video = videos[i];
-                brls::Box* cardContainer = new brls::Box();
-                cardContainer->setAxis(brls::Axis::COLUMN);
-                cardContainer->setMarginRight(25);
-                cardContainer->setMarginBottom(30);
-                cardContainer->setMarginLeft(10);
-                cardContainer->setWidth(260); // Fixed width for grid alignment
-
-                // Video Thumbnail (16:9)
-                brls::Image* thumbnail = new brls::Image();
-                thumbnail->setDimensions(256, 144);
-                thumbnail->setScalingType(brls::ImageScalingType::FILL); // Use FILL/COVER
-                thumbnail->setBackgroundColor(Theme::SurfaceDark);
-                thumbnail->setFocusable(true);
-                thumbnail->setCornerRadius(12);
-                thumbnail->addGestureRecognizer(new brls::TapGestureRecognizer(thumbnail));
-
-
-                // Asynchronously fetch medium thumbnail
-                if (!video.thumbnailUrlMedium.empty()) {
-                    Data::NetworkClient::instance().fetchImage(video.thumbnailUrlMedium, [thumbnail](const unsigned char* data, size_t size) {
-                        if (data && size > 0) thumbnail->setImageFromMem(data, size);
-                        else thumbnail->setImageFromFile("romfs:/img/video_placeholder.png");
-                    });
-                } else {
-                    thumbnail->setImageFromFile("romfs:/img/video_placeholder.png");
-                }
-
-                    thumbnail->registerAction("Play", brls::BUTTON_A, [video](brls::View* view) {
-                        brls::Logger::info("Play Video clicked: " + video.title);
-                        
-                        // Show loading dialog
-                        brls::Dialog* loadingDialog = new brls::Dialog("main/getting_stream"_i18n);
-                        loadingDialog->setCancelable(false);
-                        
-                        // Fix focus overlap issue
-                        // Make Dialog focusable so it consumes the focus ring, 
-                        // but hide the highlight so it doesn't draw a red box around itself.
-                        loadingDialog->setFocusable(true);
-                        loadingDialog->setHideHighlight(true);
-                        
-                        loadingDialog->open();
-
-                        Data::NetworkClient::instance().getStream(video.id, [loadingDialog, video](const Domain::StreamInfo& info, const std::string& error) {
-                            loadingDialog->close([info, error, video]() {
-                                if (!error.empty()) {
-                                    brls::Logger::error("Failed to fetch stream: {}", error);
-                                    brls::Dialog* errorDialog = new brls::Dialog("Failed to get stream: " + error);
-                                    errorDialog->addButton("OK", []() {});
-                                    errorDialog->open();
-                                    return;
-                                }
-                            
-                            // Push player with fetched info
-                            brls::Application::pushActivity(new PlayerActivity(info));
-                        });
-                    });
-                    return true;
-                });
-
-                // Load more when focusing on items in last 2 rows
-                if (videos.size() >= 8 && i + 8 >= videos.size()) {
-                    thumbnail->registerAction("LoadMore", brls::BUTTON_NAV_DOWN, [this](brls::View* v) {
-                        this->fetchMore();
-                        return false; // Let navigation continue
-                    });
-                }
-
-                cardContainer->addView(thumbnail);
-
-                // Metadata
-                brls::Box* metadata = new brls::Box();
-                metadata->setAxis(brls::Axis::COLUMN);
-                metadata->setMarginTop(12);
-                metadata->setWidth(256);
-
-                brls::Label* vidTitle = new brls::Label();
-                vidTitle->setText(video.title);
-                vidTitle->setFontSize(18);
-                vidTitle->setTextColor(Theme::TextPrimary);
-                vidTitle->setMarginBottom(4);
-                vidTitle->setSingleLine(true);
-                metadata->addView(vidTitle);
-
-                brls::Label* vidChannel = new brls::Label();
-                std::string channelText = video.author;
-                if (video.views != "SEARCH_HIDDEN") {
-                    channelText += " • " + UIUtils::formatViewCount(video.views);
-                }
-                vidChannel->setText(channelText);
-                vidChannel->setFontSize(14);
-                vidChannel->setTextColor(Theme::TextSecondary);
-                metadata->addView(vidChannel);
+            // Only rows near the viewport exist as views; they are recycled while scrolling
+            section->setGrow(1.0f);
 
-                cardContainer->addView(metadata);
-
-                currentRow->addView(cardContainer);
-            }
+            auto flag = this->aliveFlag;
+            this->gridContainer = new brls::RecyclerFrame();
+            this->gridContainer->setGrow(1.0f);
+            this->gridContainer->estimatedRowHeight = VideoGridCell::RowHeight;
+            this->gridContainer->registerCell("VideoRow", []() { return VideoGridCell::create(); });
+            this->gridContainer->setDataSource(new VideoGridDataSource(&this->currentVideos,
+                [this, flag](const Domain::VideoRef& video) {
+                    if (*flag) this->playVideo(video);
+                },
+                [this, flag]() {
+                    if (*flag) this->fetchMore();
+                }));
+            section->addView(this->gridContainer);
         }
 
         return section;
@@ -392,27 +308,73 @@ namespace Presentation {
         this->currentSearchQuery = "";
         this->renderVideoGrid({}); // Show skeletons
 
+        restartFeed();
+        requestPage("");
+    }
+
+    void HomeActivity::restartFeed() {
+        // Pages still downloading for the previous feed are aborted, their callbacks never run
+        Data::NetworkClient::instance().cancel(feedToken);
+        feedToken = std::make_shared<Data::CancelToken>();
+    }
+
+    void HomeActivity::requestPage(const std::string& pageToken) {
         auto flag = this->aliveFlag;
-        Data::NetworkClient::instance().getTrending([this, flag](const std::vector<Domain::VideoItem>& videos, const std::string& nextToken, const std::string& error) {
+        auto streamed = std::make_shared<size_t>(0);
+
+        auto onItems = [this, flag, streamed](const std::vector<Domain::VideoRef>& videos) {
+            if (!*flag) return;
+            *streamed += videos.size();
+            this->appendVideos(videos.begin(), videos.end());
+        };
+
+        auto callback = [this, flag, streamed](const std::vector<Domain::VideoRef>& videos, const std::string& nextToken, const std::string& error) {
             if (!*flag) return;
+
+            // Remove loading indicator
+            if (loadingIndicator && gridWrapper) {
+                gridWrapper->removeView(loadingIndicator, true);
+                loadingIndicator = nullptr;
+            }
+
+            isLoadingMore = false;
+
             if (!error.empty()) {
-                brls::Logger::error("Failed to fetch trending: {}", error);
+                brls::Logger::error("Failed to fetch {} page: {}", currentMode, error);
                 return;
             }
-            this->currentVideos = videos;
+
             this->nextPageToken = nextToken;
-            this->renderVideoGrid(videos);
-        });
+            // Rows that already streamed in are on screen; add the rest
+            size_t from = std::min(*streamed, videos.size());
+            this->appendVideos(videos.begin() + from, videos.end());
+        };
+
+        if (currentMode == "trending") {
+            Data::NetworkClient::instance().getTrending(callback, pageToken, onItems, feedToken);
+        } else if (currentMode == "search") {
+            Data::NetworkClient::instance().search(currentSearchQuery, callback, pageToken, onItems, feedToken);
+        }
     }
 
-    void HomeActivity::fetchMore() {
-        if (isLoadingMore || nextPageToken.empty()) return;
+    void HomeActivity::appendVideos(std::vector<Domain::VideoRef>::const_iterator first, std::vector<Domain::VideoRef>::const_iterator last) {
+        if (first == last) return;
 
-        // Memory safety: cap total items to prevent OOM on Switch
-        if (currentVideos.size() >= 80) {
-            brls::Logger::info("Max items reached ({}), stopping pagination", currentVideos.size());
-            return;
+        bool firstRows = this->currentVideos.empty();
+        this->currentVideos.insert(this->currentVideos.end(), first, last);
+
+        if (firstRows) {
+            // Replace the skeletons with the real grid
+            if (currentMode == "search") this->currentTitle = _("main/search") + ": " + currentSearchQuery;
+            this->renderVideoGrid(this->currentVideos);
+        } else if (gridContainer) {
+            // The recycler only creates rows as they scroll into view
+            gridContainer->notifyDataChanged();
         }
+    }
+
+    void HomeActivity::fetchMore() {
+        if (isLoadingMore || nextPageToken.empty()) return;
 
         isLoadingMore = true;
 
@@ -437,146 +399,58 @@ namespace Presentation {
             gridWrapper->addView(loadingIndicator);
         }
 
-        // Use alive flag to guard against dangling this pointer
-        auto flag = this->aliveFlag;
-        auto callback = [this, flag](const std::vector<Domain::VideoItem>& videos, const std::string& nextToken, const std::string& error) {
-            if (!*flag) return; // HomeActivity was destroyed
-
-            // Remove loading indicator
-            if (loadingIndicator && gridWrapper) {
-                gridWrapper->removeView(loadingIndicator, true);
-                loadingIndicator = nullptr;
-            }
+        requestPage(nextPageToken);
+    }
 
-            isLoadingMore = false;
+    void HomeActivity::playVideo(const Domain::VideoRef& video) {
+        brls::Logger::info("Play Video clicked: {}", video->title);
+        std::string videoId(video->id);
 
-            if (!error.empty()) {
-                brls::Logger::error("Failed to fetch more: {}", error);
-                return;
+        // Autoplay carries on through the feed or results the video was picked from
+        Domain::PlayQueue queue;
+        for (size_t i = 0; i < currentVideos.size(); i++) {
+            if (&*currentVideos[i] == &*video) {
+                queue = Domain::PlayQueue(currentVideos, i);
+                break;
             }
-
-            this->nextPageToken = nextToken;
-            // Append new videos
-            for (const auto& v : videos) {
-                this->currentVideos.push_back(v);
-            }
-            this->appendVideosToGrid(videos);
-        };
-
-        if (currentMode == "trending") {
-            Data::NetworkClient::instance().getTrending(callback, nextPageToken);
-        } else if (currentMode == "search") {
-            Data::NetworkClient::instance().search(currentSearchQuery, callback, nextPageToken);
         }
-    }
-
-    void HomeActivity::appendVideosToGrid(const std::vector<Domain::VideoItem>& videos) {
-        if (!gridWrapper || videos.empty()) return;
-
-        // Build new rows and append to gridWrapper
-        brls::Box* currentRow = nullptr;
-
-        // Figure out how many items are in the last existing row
-        // We always start from the count offset in the existing grid
-        size_t existingCount = currentVideos.size() - videos.size(); // count before append
-        size_t startOffset = existingCount % 4;
 
-        for (size_t i = 0; i < videos.size(); ++i) {
-            size_t gridPos = startOffset + i;
-            if (gridPos % 4 == 0) {
-                currentRow = new brls::Box();
-                currentRow->setAxis(brls::Axis::ROW);
-                gridWrapper->addView(currentRow);
-            }
+        // Already resolved while the card had focus: start right away
+        Domain::StreamInfo prefetched;
+        if (Data::NetworkClient::instance().getCachedStream(videoId, prefetched)) {
+            brls::Application::pushActivity(new PlayerActivity(prefetched, queue));
+            return;
+        }
 
-            const auto& video = videos[i];
-            brls::Box* cardContainer = new brls::Box();
-            cardContainer->setAxis(brls::Axis::COLUMN);
-            cardContainer->setMarginRight(25);
-            cardContainer->setMarginBottom(30);
-            cardContainer->setMarginLeft(10);
-            cardContainer->setWidth(260);
-
-            brls::Image* thumbnail = new brls::Image();
-            thumbnail->setDimensions(256, 144);
-            thumbnail->setScalingType(brls::ImageScalingType::FILL);
-            thumbnail->setBackgroundColor(Theme::SurfaceDark);
-            thumbnail->setFocusable(true);
-            thumbnail->setCornerRadius(12);
-            thumbnail->addGestureRecognizer(new brls::TapGestureRecognizer(thumbnail));
-
-            if (!video.thumbnailUrlMedium.empty()) {
-                Data::NetworkClient::instance().fetchImage(video.thumbnailUrlMedium, [thumbnail](const unsigned char* data, size_t size) {
-                    if (data && size > 0) thumbnail->setImageFromMem(data, size);
-                    else thumbnail->setImageFromFile("romfs:/img/video_placeholder.png");
-                });
-            } else {
-                thumbnail->setImageFromFile("romfs:/img/video_placeholder.png");
-            }
+        // Show loading dialog
+        brls::Dialog* loadingDialog = new brls::Dialog("main/getting_stream"_i18n);
+        loadingDialog->setCancelable(false);
+
+        // Fix focus overlap issue
+        // Make Dialog focusable so it consumes the focus ring,
+        // but hide the highlight so it doesn't draw a red box around itself.
+        loadingDialog->setFocusable(true);
+        loadingDialog->setHideHighlight(true);
+
+        loadingDialog->open();
+
+        Data::NetworkClient::instance().getStream(videoId, [loadingDialog, queue](const Domain::StreamInfo& info, const std::string& error) {
+            loadingDialog->close([info, error, queue]() {
+                if (!error.empty()) {
+                    brls::Logger::error("Failed to fetch stream: {}", error);
+                    brls::Dialog* errorDialog = new brls::Dialog("Failed to get stream: " + error);
+                    errorDialog->addButton("OK", []() {});
+                    errorDialog->open();
+                    return;
+                }
 
-            // Play action
-            thumbnail->registerAction("Play", brls::BUTTON_A, [video](brls::View* view) {
-                brls::Logger::info("Play Video clicked: " + video.title);
-                brls::Dialog* loadingDialog = new brls::Dialog("main/getting_stream"_i18n);
-                loadingDialog->setCancelable(false);
-                loadingDialog->setFocusable(true);
-                loadingDialog->setHideHighlight(true);
-                loadingDialog->open();
-
-                Data::NetworkClient::instance().getStream(video.id, [loadingDialog, video](const Domain::StreamInfo& info, const std::string& error) {
-                    loadingDialog->close([info, error, video]() {
-                        if (!error.empty()) {
-                            brls::Logger::error("Failed to fetch stream: {}", error);
-                            brls::Dialog* errorDialog = new brls::Dialog("Failed to get stream: " + error);
-                            errorDialog->addButton("OK", []() {});
-                            errorDialog->open();
-                            return;
-                        }
-                        brls::Application::pushActivity(new PlayerActivity(info));
-                    });
-                });
-                return true;
+                // Push player with fetched info
+                brls::Application::pushActivity(new PlayerActivity(info, queue));
             });
-
-            // Load more when focusing on items in the last 2 rows
-            if (videos.size() >= 8 && i + 8 >= videos.size()) {
-                thumbnail->registerAction("LoadMore", brls::BUTTON_NAV_DOWN, [this](brls::View* v) {
-                    this->fetchMore();
-                    return false; // Let navigation continue
-                });
-            }
-
-            cardContainer->addView(thumbnail);
-
-            brls::Box* metadata = new brls::Box();
-            metadata->setAxis(brls::Axis::COLUMN);
-            metadata->setMarginTop(12);
-            metadata->setWidth(256);
-
-            brls::Label* vidTitle = new brls::Label();
-            vidTitle->setText(video.title);
-            vidTitle->setFontSize(18);
-            vidTitle->setTextColor(Theme::TextPrimary);
-            vidTitle->setMarginBottom(4);
-            vidTitle->setSingleLine(true);
-            metadata->addView(vidTitle);
-
-            brls::Label* vidChannel = new brls::Label();
-            std::string channelText = video.author;
-            if (video.views != "SEARCH_HIDDEN") {
-                channelText += " • " + UIUtils::formatViewCount(video.views);
-            }
-            vidChannel->setText(channelText);
-            vidChannel->setFontSize(14);
-            vidChannel->setTextColor(Theme::TextSecondary);
-            metadata->addView(vidChannel);
-
-            cardContainer->addView(metadata);
-            currentRow->addView(cardContainer);
-        }
+        });
     }
 
-    void HomeActivity::renderVideoGrid(const std::vector<Domain::VideoItem>& videos) {
+    void HomeActivity::renderVideoGrid(const std::vector<Domain::VideoRef>& videos) {
         // Re-render main content
         this->gridWrapper = nullptr;
         this->gridContainer = nullptr;
@@ -607,18 +481,8 @@ namespace Presentation {
                     this->currentSearchQuery = text;
                     this->renderVideoGrid({}); // Show skeletons
 
-                    auto flag = this->aliveFlag;
-                    Data::NetworkClient::instance().search(text, [this, text, flag](const std::vector<Domain::VideoItem>& videos, const std::string& nextToken, const std::string& error) {
-                        if (!*flag) return;
-                        if (!error.empty()) {
-                            brls::Logger::error("Search failed: {}", error);
-                            return;
-                        }
-                        this->currentTitle = _("main/search") + ": " + text;
-                        this->currentVideos = videos;
-                        this->nextPageToken = nextToken;
-                        this->renderVideoGrid(videos);
-                    });
+                    restartFeed();
+                    requestPage("");
                 }
             },
             _("main/search_darktube"),
@@ -779,9 +643,32 @@ namespace Presentation {
             this->renderSettingsView(); // Refresh to show updated state
             return true;
         });
-        proxyBtn->setMarginBottom(30);
+        proxyBtn->setMarginBottom(10);
         inner->addView(proxyBtn);
 
+        bool currentPowerSaving = Data::IPRepository::getInstance().getPowerSaving();
+        std::string powerSavingLabel = "Power Saving: " + std::string(currentPowerSaving ? "ON ✓" : "OFF");
+        brls::Box* powerSavingBtn = createSidebarItem(powerSavingLabel, [this](brls::View* v) {
+            bool enabled = !Data::IPRepository::getInstance().getPowerSaving();
+            Data::IPRepository::getInstance().setPowerSaving(enabled);
+            FramePacer::instance().setEnabled(enabled);
+            this->renderSettingsView(); // Refresh to show updated state
+            return true;
+        });
+        powerSavingBtn->setMarginBottom(10);
+        inner->addView(powerSavingBtn);
+
+        bool currentDiskCache = Data::IPRepository::getInstance().getDiskCache();
+        std::string diskCacheLabel = "Disk Cache: " + std::string(currentDiskCache ? "ON ✓" : "OFF");
+        brls::Box* diskCacheBtn = createSidebarItem(diskCacheLabel, [this](brls::View* v) {
+            bool current = Data::IPRepository::getInstance().getDiskCache();
+            Data::IPRepository::getInstance().setDiskCache(!current);
+            this->renderSettingsView(); // Refresh to show updated state
+            return true;
+        });
+        diskCacheBtn->setMarginBottom(30);
+        inner->addView(diskCacheBtn);
+
         // --- INFO SECTIONS ---
 
         addSection(_("main/developer_info"), _("main/dev_desc"));
@@ -913,6 +800,12 @@ namespace Presentation {
         if (rootBox && rootBox->getChildren().size() > 0) {
             brls::Box* split = dynamic_cast<brls::Box*>(rootBox->getChildren()[0]);
             if (split && split->getChildren().size() >= 2) {
+                // Pages still downloading would land in the grid that is about to be freed
+                restartFeed();
+                isLoadingMore = false;
+                this->gridWrapper = nullptr;
+                this->gridContainer = nullptr;
+                this->loadingIndicator = nullptr;
                 split->removeView(mainContent, true); // true to free memory
                 mainContent = createSettingsView();
                 split->addView(mainContent);
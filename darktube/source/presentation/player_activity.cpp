@@ -1,14 +1,102 @@
 #include "../include/presentation/player_activity.hpp"
 #include "../include/core/theme.hpp"
 #include "view/mpv_core.hpp"
+#include "view/frame_profiler.hpp"
 #include "../include/presentation/ui_utils.hpp"
 #include "../include/data/network_client.hpp"
 #include "../include/data/ip_repository.hpp"
 #include <borealis.hpp>
+#include <algorithm>
+
+#ifdef __SWITCH__
+#define AUTO_QUALITY_MAX_HEIGHT 720 // mpv decodes in software there (hwdec=no)
+#else
+#define AUTO_QUALITY_MAX_HEIGHT 1080
+#endif
 
 namespace DarkTube {
 namespace Presentation {
 
+    // Adaptive quality pacing, in ms
+    static constexpr brls::Time QualityCheckInterval = 1000;
+    static constexpr brls::Time QualityDownCooldown = 10000; // since the start or the last switch
+    static constexpr brls::Time QualityUpCooldown = 30000;
+    // Autoplay resolves the next video this long before the current one ends
+    static constexpr double NextPrefetchSec = 30;
+
+    // What mpv should load for `format`, through the proxy when it is enabled
+    static void formatUrls(const Domain::StreamInfo& info, const Domain::StreamFormat& format, std::string& url, std::string& audio) {
+        const Data::ConfigSnapshot& config = Data::IPRepository::getInstance().getConfig();
+        bool useProxy = config.useProxy;
+        const std::string& baseUrl = config.baseUrl;
+
+        if (useProxy && !format.proxyUrl.empty()) {
+            url = baseUrl + format.proxyUrl;
+        } else {
+            url = format.url;
+        }
+
+        audio = "";
+        if (format.type == "videoOnly") {
+            if (useProxy && !info.audioProxyUrl.empty()) {
+                audio = baseUrl + info.audioProxyUrl;
+            } else {
+                audio = info.audioUrl;
+            }
+        }
+    }
+
+    // Format to start `info` at, and the urls to load for it: what the measured bandwidth
+    // can carry, or the server's default without a measurement yet. muxedOnly passes over
+    // formats that need the separate audio track where it can. Returns -1 when the
+    // default url matches no format.
+    static int pickStartFormat(const Domain::StreamInfo& info, bool muxedOnly, std::string& url, std::string& audio) {
+        Domain::QualitySelector quality(info.formats, AUTO_QUALITY_MAX_HEIGHT);
+        double kbps = Data::NetworkClient::instance().getBandwidthEstimator().getEstimateKbps();
+        if (kbps > 0 && !quality.empty()) {
+            for (int rung = (int)quality.pickForBandwidth(kbps); rung >= 0; rung--) {
+                const auto& format = info.formats[quality.formatAt(rung)];
+                if (muxedOnly && format.type == "videoOnly") continue;
+                formatUrls(info, format, url, audio);
+                brls::Logger::info("Auto quality: starting at {} ({:.0f} kbps estimated)", format.quality, kbps);
+                return (int)quality.formatAt(rung);
+            }
+        }
+
+        // The default is the first muxed format, whose proxyUrl the parser copied
+        int start = -1;
+        for (size_t i = 0; i < info.formats.size() && start < 0; i++) {
+            const auto& format = info.formats[i];
+            if (format.url == info.url || (!info.proxyUrl.empty() && format.proxyUrl == info.proxyUrl)) {
+                start = (int)i;
+            }
+        }
+
+        url = info.url;
+        audio = info.audioUrl;
+        const Data::ConfigSnapshot& config = Data::IPRepository::getInstance().getConfig();
+        if (config.useProxy) {
+            const std::string& baseUrl = config.baseUrl;
+            if (!info.proxyUrl.empty()) {
+                url = baseUrl + info.proxyUrl;
+            }
+            if (!info.audioProxyUrl.empty() && !info.audioUrl.empty()) {
+                audio = baseUrl + info.audioProxyUrl;
+            }
+        }
+        if (muxedOnly && start >= 0 && info.formats[start].type == "muxed") audio = "";
+        return start;
+    }
+
+    // Sized for the highest rung auto quality may climb to
+    static void planCache(const Domain::StreamInfo& info, int startFormat) {
+        Domain::QualitySelector quality(info.formats, AUTO_QUALITY_MAX_HEIGHT);
+        double kbps = !quality.empty() ? quality.kbpsAt(quality.size() - 1)
+                    : startFormat >= 0 ? info.formats[startFormat].bitrateKbps : 0;
+        MPVCore::instance().setCacheProfile(Domain::CacheProfile::choose(MPVCore::getAvailableMemory(), kbps, info.duration,
+                                                                         Data::IPRepository::getInstance().getDiskCache()));
+    }
+
     // --- VideoPlayerView ---
 
     VideoPlayerView::VideoPlayerView() {
@@ -22,12 +110,52 @@ namespace Presentation {
         MPVCore::instance().draw(brls::Rect(x, y, width, height));
 
         // Draw overlay children
-        Box::draw(vg, x, y, width, height, style, ctx);
+        ProfiledBox::draw(vg, x, y, width, height, style, ctx);
+
+        if (FrameProfiler::instance().isOverlayVisible()) drawPlayerStats(vg, x, y + height);
+    }
+
+    // Demuxer cache profile and use, and the last gap between videos, shown along with
+    // the profiler overlay
+    void VideoPlayerView::drawPlayerStats(NVGcontext* vg, float x, float bottom) {
+        const Domain::CacheProfile& profile = MPVCore::instance().getCacheProfile();
+        MPVCore::PlaybackState state = MPVCore::instance().getState();
+        const double mib = Domain::CacheProfile::MiB;
+
+        char cacheLine[160];
+        snprintf(cacheLine, sizeof(cacheLine), "Cache %s%s: %.1f / %.0f+%.0f MiB, %.1f s ahead", profile.name.c_str(), profile.onDisk ? " (disk)" : "",
+            state.cacheBytes / mib, profile.maxBytes / mib, profile.maxBackBytes / mib, state.cacheSeconds);
+        char gapLine[64];
+        double gapMs = MPVCore::instance().getLastGapMs();
+        if (gapMs >= 0) {
+            snprintf(gapLine, sizeof(gapLine), "Last gap between videos: %.0f ms", gapMs);
+        } else {
+            snprintf(gapLine, sizeof(gapLine), "Last gap between videos: -");
+        }
+
+        nvgSave(vg);
+        nvgBeginPath(vg);
+        nvgRoundedRect(vg, x + 20, bottom - 76, 460, 56, 8);
+        nvgFillColor(vg, nvgRGBA(0, 0, 0, 200));
+        nvgFill(vg);
+
+        nvgFontFaceId(vg, brls::Application::getFont(FONT_REGULAR));
+        nvgFontSize(vg, 16);
+        nvgTextAlign(vg, NVG_ALIGN_LEFT | NVG_ALIGN_TOP);
+        nvgFillColor(vg, nvgRGB(255, 255, 255));
+        nvgText(vg, x + 32, bottom - 68, cacheLine, nullptr);
+        nvgText(vg, x + 32, bottom - 48, gapLine, nullptr);
+        nvgRestore(vg);
     }
 
     // --- PlayerOverlayView ---
 
-    PlayerOverlayView::PlayerOverlayView(const Domain::StreamInfo& info) : streamInfo(info) {
+    PlayerOverlayView::PlayerOverlayView(const Domain::StreamInfo& info, int startFormat, const Domain::PlayQueue& queue)
+        : streamInfo(info), quality(info.formats, AUTO_QUALITY_MAX_HEIGHT), queue(queue) {
+        if (startFormat >= 0) currentRung = quality.rungOf(startFormat);
+        qualityLastSwitch = brls::getCPUTimeUsec() / 1000;
+        shownItem = MPVCore::instance().getState().playlistItem;
+
         this->setWidthPercentage(100);
         this->setHeightPercentage(100);
         this->setFocusable(true);
@@ -61,12 +189,14 @@ namespace Presentation {
 
         // Actions
         this->registerAction("Toggle Play", brls::BUTTON_A, [this](brls::View* view) {
+            FrameProfiler::instance().markInput();
             brls::Logger::info("Button A pressed on PlayerOverlayView");
-            if (MPVCore::instance().isEOF()) {
+            MPVCore::PlaybackState state = MPVCore::instance().getState();
+            if (state.eof) {
                 brls::Logger::info("Video EOF. Restarting.");
                 MPVCore::instance().restart();
                 this->toggleOSD(false);
-            } else if (MPVCore::instance().isPaused()) {
+            } else if (state.isPaused()) {
                 brls::Logger::info("Resuming video");
                 MPVCore::instance().resume();
                 this->toggleOSD(false);
@@ -88,6 +218,7 @@ namespace Presentation {
         });
 
         this->registerAction("Seek Forward", brls::BUTTON_RIGHT, [this](brls::View* view) {
+            FrameProfiler::instance().markInput();
             brls::Logger::info("Seek +10s");
             MPVCore::instance().seek(10);
             this->toggleOSD(true); // Show OSD when seeking
@@ -95,6 +226,7 @@ namespace Presentation {
         });
         
         this->registerAction("Seek Backward", brls::BUTTON_LEFT, [this](brls::View* view) {
+            FrameProfiler::instance().markInput();
             brls::Logger::info("Seek -10s");
             MPVCore::instance().seek(-10);
             this->toggleOSD(true); // Show OSD when seeking
@@ -102,11 +234,13 @@ namespace Presentation {
         });
 
         this->registerAction("Show OSD", brls::BUTTON_UP, [this](brls::View* view) {
+            FrameProfiler::instance().markInput();
             this->toggleOSD(true);
             return true;
         });
 
         this->registerAction("Hide OSD", brls::BUTTON_DOWN, [this](brls::View* view) {
+            FrameProfiler::instance().markInput();
             this->toggleOSD(false);
             return true;
         });
@@ -130,6 +264,7 @@ namespace Presentation {
             bottomBar->setVisibility(brls::Visibility::VISIBLE);
             this->setBackgroundColor(nvgRGBA(0, 0, 0, 160)); // Darker overlay for YouTube TV feel
             osdLastTick = brls::getCPUTimeUsec() / 1000;
+            osdSynced = false; // nothing was updated while hidden
         } else {
             // Hide OSD
             topBar->setVisibility(brls::Visibility::INVISIBLE);
@@ -139,8 +274,11 @@ namespace Presentation {
     }
 
     void PlayerOverlayView::frame(brls::FrameContext* ctx) {
+        // Lock-free snapshot published by the mpv event thread
+        MPVCore::PlaybackState state = MPVCore::instance().getState();
+
         // Poll for buffering state and toggle the loader
-        bool showSpinner = MPVCore::instance().isBuffering();
+        bool showSpinner = state.buffering;
         
         if (showSpinner) {
             if (bufferingLoader->getVisibility() != brls::Visibility::VISIBLE) {
@@ -153,19 +291,26 @@ namespace Presentation {
         }
         
         // Auto-hide OSD
-        if (osdVisible && !MPVCore::instance().isPaused() && !MPVCore::instance().isEOF()) {
+        if (osdVisible && !state.isPaused() && !state.eof) {
             if (brls::getCPUTimeUsec() / 1000 - osdLastTick > osdTimeout) {
                 this->toggleOSD(false);
             }
         }
 
+        // Before the EOF check, so autoplay doesn't flash the OSD
+        updateQueue();
+        state = MPVCore::instance().getState();
+
         // Show OSD when video ends
-        if (MPVCore::instance().isEOF() && !osdVisible) {
+        if (state.eof && !osdVisible) {
             this->toggleOSD(true);
         }
 
-        // Update playback info
-        updatePlaybackInfo();
+        MPVCore::instance().updateSwitch();
+        updateAdaptiveQuality();
+
+        // Update playback info; hidden labels aren't worth a relayout
+        if (osdVisible) updatePlaybackInfo();
         
         // Pass to base class for rendering
         brls::Box::frame(ctx);
@@ -179,11 +324,11 @@ namespace Presentation {
         bar->setAlignItems(brls::AlignItems::CENTER);
         bar->setPadding(40, 60, 0, 60); // Top margin
 
-        brls::Label* videoTitleLabel = new brls::Label();
-        videoTitleLabel->setText(streamInfo.title + " | DarkTube");
-        videoTitleLabel->setFontSize(28);
-        videoTitleLabel->setTextColor(Theme::TextPrimary);
-        bar->addView(videoTitleLabel);
+        titleLabel = new brls::Label();
+        titleLabel->setText(streamInfo.title + " | DarkTube");
+        titleLabel->setFontSize(28);
+        titleLabel->setTextColor(Theme::TextPrimary);
+        bar->addView(titleLabel);
 
         return bar;
     }
@@ -269,27 +414,44 @@ namespace Presentation {
     }
 
     void PlayerOverlayView::updatePlaybackInfo() {
-        auto& mpv = MPVCore::instance();
-        
+        MPVCore::PlaybackState state = MPVCore::instance().getState();
+        if (osdSynced && state.version == shownVersion) return;
+
         // Update status label
-        if (mpv.isBuffering()) {
-            statusLabel->setText("BUFFERING...");
-        } else if (mpv.isEOF()) {
-            statusLabel->setText("FINISHED");
-        } else if (mpv.isPaused()) {
-            statusLabel->setText("PAUSED");
-        } else {
-            statusLabel->setText("PLAYING");
+        std::string status = "PLAYING";
+        if (state.buffering) {
+            status = "BUFFERING...";
+        } else if (state.eof) {
+            status = "FINISHED";
+        } else if (state.isPaused()) {
+            status = "PAUSED";
+        }
+        if (!osdSynced || status != shownStatus) {
+            statusLabel->setText(status);
+            shownStatus = status;
         }
 
-        // Update time label
-        double currentTime = mpv.getPlaybackTime();
-        double duration = mpv.getDuration();
-        timeLabel->setText(formatTime(currentTime) + " / " + formatTime(duration));
+        // Update time label, which only shows whole seconds
+        int seconds = (int)std::max(state.time, 0.0);
+        int duration = (int)std::max(state.duration, 0.0);
+        if (!osdSynced || seconds != shownSeconds || duration != shownDuration) {
+            timeLabel->setText(formatTime(seconds) + " / " + formatTime(duration));
+            shownSeconds = seconds;
+            shownDuration = duration;
+        }
+
+        // Update progress bar, at most once per progressInterval
+        float progress = state.progress() * 100.0f;
+        if (!osdSynced || progress != shownProgress) {
+            brls::Time now = brls::getCPUTimeUsec() / 1000;
+            if (osdSynced && now - progressLastTick < progressInterval) return; // retried next frame
+            progressFill->setWidthPercentage(progress);
+            shownProgress = progress;
+            progressLastTick = now;
+        }
 
-        // Update progress bar
-        float progress = mpv.getPlaybackProgress();
-        progressFill->setWidthPercentage(progress * 100.0f);
+        shownVersion = state.version;
+        osdSynced = true;
     }
 
     std::string PlayerOverlayView::formatTime(double seconds) {
@@ -307,6 +469,10 @@ namespace Presentation {
         return std::string(buf);
     }
 
+    PlayerOverlayView::~PlayerOverlayView() {
+        if (nextToken) nextToken->cancel();
+    }
+
     void PlayerOverlayView::onFocusGained() {
         brls::Box::onFocusGained();
     }
@@ -323,80 +489,148 @@ namespace Presentation {
             return;
         }
 
-        bool useProxy = Data::IPRepository::getInstance().getUseProxy();
-        std::string baseUrl = "";
-        if (useProxy) {
-            auto server = Data::IPRepository::getInstance().getActiveServer();
-            if (!server.address.empty()) {
-                if (server.address.find("http") == std::string::npos) {
-                    baseUrl = "http://" + server.address + ":3000";
-                } else {
-                    baseUrl = server.address;
-                }
-            }
-        }
-
         brls::Dialog* dialog = new brls::Dialog("Select Quality");
-        for (const auto& format : streamInfo.formats) {
+        if (!quality.empty()) {
+            dialog->addButton(autoQuality ? "Auto ✓" : "Auto", [this]() {
+                brls::Logger::info("Auto quality: on");
+                autoQuality = true;
+            });
+        }
+        for (size_t i = 0; i < streamInfo.formats.size(); i++) {
             // Clean label: just quality + type indicator
+            const auto& format = streamInfo.formats[i];
             std::string label = format.quality;
             if (format.type == "muxed") {
                 label += " (A+V)";
             }
 
-            std::string url;
-            if (useProxy && !format.proxyUrl.empty()) {
-                url = baseUrl + format.proxyUrl;
-            } else {
-                url = format.url;
-            }
-
-            std::string audio = "";
-            if (format.type == "videoOnly") {
-                if (useProxy && !streamInfo.audioProxyUrl.empty()) {
-                    audio = baseUrl + streamInfo.audioProxyUrl;
-                } else {
-                    audio = streamInfo.audioUrl;
-                }
-            }
-
-            dialog->addButton(label, [url, audio]() {
-                brls::Logger::info("Switching to quality: {}", url);
-                MPVCore::instance().setUrl(url, audio);
-                MPVCore::instance().resume();
+            dialog->addButton(label, [this, i]() {
+                autoQuality = false;
+                this->switchFormat(i, true);
             });
         }
         dialog->addButton("Cancel", []() {});
         dialog->open();
     }
 
-    // --- PlayerActivity ---
+    // Samples mpv's download rate and steps the quality up or down with buffer health
+    void PlayerOverlayView::updateAdaptiveQuality() {
+        brls::Time now = brls::getCPUTimeUsec() / 1000;
+        if (now - qualityLastCheck < QualityCheckInterval) return;
+        double elapsed = (now - qualityLastCheck) / 1000.0;
+        qualityLastCheck = now;
 
-    PlayerActivity::PlayerActivity(const Domain::StreamInfo& info) 
-        : streamInfo(info) {
-        brls::Logger::info("User pushed PlayerActivity: " + streamInfo.title);
+        MPVCore::PlaybackState state = MPVCore::instance().getState();
+        if (state.stopped || state.eof || (!state.playing && !state.buffering)) return;
 
-        bool useProxy = Data::IPRepository::getInstance().getUseProxy();
-        std::string playUrl = streamInfo.url;
-        std::string playAudio = streamInfo.audioUrl;
-
-        if (useProxy) {
-            auto server = Data::IPRepository::getInstance().getActiveServer();
-            std::string baseUrl = "";
-            if (!server.address.empty()) {
-                if (server.address.find("http") == std::string::npos) {
-                    baseUrl = "http://" + server.address + ":3000";
-                } else {
-                    baseUrl = server.address;
-                }
-            }
-            if (!streamInfo.proxyUrl.empty()) {
-                playUrl = baseUrl + streamInfo.proxyUrl;
+        // The cache's input rate only measures the link while it is filling
+        auto& bandwidth = Data::NetworkClient::instance().getBandwidthEstimator();
+        if (!state.cacheIdle && state.inputBytesPerSec > 0 && elapsed < 2 * QualityCheckInterval / 1000.0) {
+            bandwidth.addSample(state.inputBytesPerSec * elapsed, elapsed);
+        }
+
+        if (!autoQuality || currentRung < 0 || MPVCore::instance().isSwitching()) return;
+        if (now - qualityLastSwitch < QualityDownCooldown) return;
+
+        double kbps = bandwidth.getEstimateKbps();
+        size_t rung = quality.next(currentRung, kbps, state.cacheSeconds, state.buffering);
+        if (rung == (size_t)currentRung) return;
+        if (rung > (size_t)currentRung && now - qualityLastSwitch < QualityUpCooldown) return;
+
+        brls::Logger::info("Auto quality: {} -> {} ({:.0f} kbps estimated, {:.1f}s buffered{})",
+                           streamInfo.formats[quality.formatAt(currentRung)].quality, streamInfo.formats[quality.formatAt(rung)].quality,
+                           kbps, state.cacheSeconds, state.buffering ? ", rebuffering" : "");
+        // Already stalled: there is nothing left to keep playing while the new one buffers
+        switchFormat(quality.formatAt(rung), !state.buffering);
+    }
+
+    // Keeps the current position; seamless buffers the new format before swapping it in
+    void PlayerOverlayView::switchFormat(size_t format, bool seamless) {
+        std::string url, audio;
+        formatUrls(streamInfo, streamInfo.formats[format], url, audio);
+        currentRung = quality.rungOf(format);
+        qualityLastSwitch = brls::getCPUTimeUsec() / 1000;
+
+        brls::Logger::info("Switching to quality: {}", url);
+        MPVCore::instance().switchUrl(url, audio, seamless);
+    }
+
+    // Resolves the next video shortly before this one ends, and plays it at the end:
+    // mpv moves on by itself when it was queued, otherwise it is loaded at EOF
+    void PlayerOverlayView::updateQueue() {
+        if (!queue.hasNext()) return;
+        MPVCore::PlaybackState state = MPVCore::instance().getState();
+
+        if (state.playlistItem != shownItem) {
+            shownItem = state.playlistItem;
+            advanceQueue();
+            return;
+        }
+        if (!nextRequested && state.duration > 0 && (state.eof || state.duration - state.time < NextPrefetchSec)) {
+            requestNext();
+        }
+        if (state.eof && nextResolved && !nextQueued) {
+            planCache(nextInfo, nextFormat);
+            MPVCore::instance().setUrl(nextUrl, nextAudio);
+            MPVCore::instance().resume();
+            advanceQueue();
+        }
+    }
+
+    void PlayerOverlayView::requestNext() {
+        nextRequested = true;
+        nextToken = std::make_shared<Data::CancelToken>();
+        std::string videoId(queue.next()->id);
+        brls::Logger::info("Autoplay: resolving next video {}", videoId);
+
+        Data::NetworkClient::instance().getStream(videoId, [this](const Domain::StreamInfo& info, const std::string& error) {
+            if (!error.empty()) {
+                brls::Logger::error("Autoplay: failed to get next stream: {}", error);
+                return;
             }
-            if (!streamInfo.audioProxyUrl.empty() && !streamInfo.audioUrl.empty()) {
-                playAudio = baseUrl + streamInfo.audioProxyUrl;
+            nextInfo = info;
+            nextFormat = pickStartFormat(nextInfo, true, nextUrl, nextAudio);
+            nextResolved = true;
+
+            // mpv adds the separate audio track only once a file has loaded, too late for
+            // a prefetched entry; such a video is loaded at EOF instead
+            if (nextAudio.empty()) {
+                planCache(nextInfo, nextFormat);
+                MPVCore::instance().queueNext(nextUrl);
+                nextQueued = true;
             }
-        }
+            brls::Logger::info("Autoplay: next is {}{}", nextInfo.title, nextQueued ? " (prefetching)" : "");
+        }, nextToken);
+    }
+
+    // The next video is playing or loading: it becomes the one the overlay is about
+    void PlayerOverlayView::advanceQueue() {
+        queue.advance();
+        streamInfo = nextInfo;
+        quality = Domain::QualitySelector(streamInfo.formats, AUTO_QUALITY_MAX_HEIGHT);
+        currentRung = nextFormat >= 0 ? quality.rungOf(nextFormat) : -1;
+        qualityLastSwitch = brls::getCPUTimeUsec() / 1000;
+        titleLabel->setText(streamInfo.title + " | DarkTube");
+
+        nextRequested = false;
+        nextResolved = false;
+        nextQueued = false;
+        nextInfo = Domain::StreamInfo();
+        nextFormat = -1;
+        osdSynced = false;
+        if (osdVisible) this->toggleOSD(false);
+        brls::Logger::info("Autoplay: now playing {}", streamInfo.title);
+    }
+
+    // --- PlayerActivity ---
+
+    PlayerActivity::PlayerActivity(const Domain::StreamInfo& info, const Domain::PlayQueue& queue)
+        : streamInfo(info), queue(queue) {
+        brls::Logger::info("User pushed PlayerActivity: " + streamInfo.title);
+
+        std::string playUrl, playAudio;
+        startFormat = pickStartFormat(streamInfo, false, playUrl, playAudio);
+        planCache(streamInfo, startFormat);
 
         MPVCore::instance().setUrl(playUrl, playAudio);
         MPVCore::instance().resume();
@@ -411,7 +645,7 @@ namespace Presentation {
         VideoPlayerView* videoView = new VideoPlayerView();
         
         // Add overlay that fades in/out on interaction
-        PlayerOverlayView* overlay = new PlayerOverlayView(streamInfo);
+        PlayerOverlayView* overlay = new PlayerOverlayView(streamInfo, startFormat, queue);
         videoView->addView(overlay);
 
         // Ensure the overlay gets focus so A/B inputs are not swallowed by the VideoView
@@ -5,6 +5,7 @@
 #include "../include/domain/models.hpp"
 #include <borealis.hpp>
 #include "../include/presentation/ui_utils.hpp"
+#include "view/profiled_box.hpp"
 
 namespace DarkTube {
 namespace Presentation {
@@ -15,7 +16,7 @@ namespace Presentation {
     }
 
     brls::View* ServerListActivity::createContentView() {
-        brls::Box* root = new brls::Box();
+        brls::Box* root = new ProfiledBox();
         root->setAxis(brls::Axis::COLUMN);
         root->setWidthPercentage(100);
         root->setHeightPercentage(100);
@@ -0,0 +1,183 @@
+#include "../include/presentation/video_grid.hpp"
+#include "../include/presentation/ui_utils.hpp"
+#include "../include/core/theme.hpp"
+#include "../include/data/network_client.hpp"
+#include "view/frame_profiler.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace DarkTube {
+namespace Presentation {
+
+    // --- VideoCard ---
+
+    long VideoCard::prefetchDwellMs = 400;
+
+    VideoCard::VideoCard() {
+        this->setAxis(brls::Axis::COLUMN);
+        this->setMarginRight(25);
+        this->setMarginBottom(30);
+        this->setMarginLeft(10);
+        this->setWidth(260); // Fixed width for grid alignment
+
+        // Video Thumbnail (16:9)
+        thumbnail = new ThumbnailImage();
+        thumbnail->setDimensions(256, 144);
+        thumbnail->setScalingType(brls::ImageScalingType::FILL); // Use FILL/COVER
+        thumbnail->setBackgroundColor(Theme::SurfaceDark);
+        thumbnail->setFocusable(true);
+        thumbnail->setCornerRadius(12);
+        thumbnail->addGestureRecognizer(new brls::TapGestureRecognizer(thumbnail));
+
+        // Registered once; the handler is rebound whenever the card is recycled
+        thumbnail->registerAction("Play", brls::BUTTON_A, [this](brls::View* view) {
+            FrameProfiler::instance().markInput();
+            if (this->onPlay) this->onPlay();
+            return true;
+        });
+
+        // Speculatively resolve the stream when the user lingers on a card
+        thumbnail->getFocusEvent()->subscribe([this](brls::View* view) {
+            if (this->onFocus) this->onFocus();
+
+            size_t serial = ++this->focusSerial;
+            auto alive = this->alive;
+            brls::delay(prefetchDwellMs, [this, alive, serial]() {
+                if (!*alive || serial != this->focusSerial) return;
+                if (brls::Application::getCurrentFocus() != this->thumbnail) return;
+                if (this->onFocusDwell) this->onFocusDwell();
+            });
+        });
+        this->addView(thumbnail);
+
+        // Metadata
+        brls::Box* metadata = new brls::Box();
+        metadata->setAxis(brls::Axis::COLUMN);
+        metadata->setMarginTop(12);
+        metadata->setWidth(256);
+
+        titleLabel = new brls::Label();
+        titleLabel->setFontSize(18);
+        titleLabel->setTextColor(Theme::TextPrimary);
+        titleLabel->setMarginBottom(4);
+        titleLabel->setSingleLine(true);
+        metadata->addView(titleLabel);
+
+        channelLabel = new brls::Label();
+        channelLabel->setFontSize(14);
+        channelLabel->setTextColor(Theme::TextSecondary);
+        metadata->addView(channelLabel);
+
+        this->addView(metadata);
+    }
+
+    VideoCard::~VideoCard() {
+        *alive = false;
+    }
+
+    void VideoCard::setVideo(const Domain::VideoRef& video) {
+        focusSerial++;
+        this->setVisibility(brls::Visibility::VISIBLE);
+        thumbnail->setFocusable(true);
+        thumbnail->setThumbnailUrl(std::string(video->thumbnailUrlMedium));
+
+        titleLabel->setText(std::string(video->title));
+
+        std::string channelText(video->author);
+        if (video->views != "SEARCH_HIDDEN") {
+            channelText += " • " + UIUtils::formatViewCount(std::string(video->views));
+        }
+        channelLabel->setText(channelText);
+    }
+
+    void VideoCard::clearVideo() {
+        // Trailing slots of the last, partially filled row
+        this->setVisibility(brls::Visibility::INVISIBLE);
+        thumbnail->setFocusable(false);
+        thumbnail->setThumbnailUrl("");
+        focusSerial++;
+        onPlay = nullptr;
+        onFocus = nullptr;
+        onFocusDwell = nullptr;
+    }
+
+    // --- VideoGridCell ---
+
+    VideoGridCell::VideoGridCell() {
+        this->setAxis(brls::Axis::ROW);
+        this->setHeight(RowHeight);
+        this->setFocusable(false); // Focus goes to the thumbnails inside
+
+        for (int i = 0; i < Columns; i++) {
+            cards[i] = new VideoCard();
+            this->addView(cards[i]);
+        }
+    }
+
+    VideoGridCell* VideoGridCell::create() {
+        return new VideoGridCell();
+    }
+
+    void VideoGridCell::cacheForReuse() {
+        for (int i = 0; i < Columns; i++) {
+            cards[i]->thumbnail->cancelLoad();
+        }
+    }
+
+    // --- VideoGridDataSource ---
+
+    VideoGridDataSource::VideoGridDataSource(const std::vector<Domain::VideoRef>* videos, PlayHandler onPlay, std::function<void()> onNearEnd)
+        : videos(videos), onPlay(onPlay), onNearEnd(onNearEnd) {}
+
+    int VideoGridDataSource::numberOfRows(brls::RecyclerFrame* recycler, int section) {
+        return (int)((videos->size() + VideoGridCell::Columns - 1) / VideoGridCell::Columns);
+    }
+
+    float VideoGridDataSource::heightForRow(brls::RecyclerFrame* recycler, brls::IndexPath index) {
+        return VideoGridCell::RowHeight;
+    }
+
+    brls::RecyclerCell* VideoGridDataSource::cellForRow(brls::RecyclerFrame* recycler, brls::IndexPath index) {
+        auto* cell = dynamic_cast<VideoGridCell*>(recycler->dequeueReusableCell("VideoRow"));
+
+        for (int i = 0; i < VideoGridCell::Columns; i++) {
+            size_t position = (size_t)index.row * VideoGridCell::Columns + i;
+            VideoCard* card = cell->cards[i];
+
+            if (position >= videos->size()) {
+                card->clearVideo();
+                continue;
+            }
+
+            // Distance in cards from the focus, with rows weighing a full row of columns
+            auto focus = focusedIndex;
+            long at = (long)position;
+            card->thumbnail->setLoadPriority([focus, at]() {
+                long focused = focus->load();
+                long rows = std::labs(at / VideoGridCell::Columns - focused / VideoGridCell::Columns);
+                long columns = std::labs(at % VideoGridCell::Columns - focused % VideoGridCell::Columns);
+                return Data::RequestPriority::Thumbnail + (int)std::min(rows * VideoGridCell::Columns + columns, 100000L);
+            });
+            card->onFocus = [focus, at]() { focus->store(at); };
+
+            card->setVideo((*videos)[position]);
+            card->onPlay = [this, position]() {
+                if (position < videos->size()) onPlay((*videos)[position]);
+            };
+            Domain::VideoRef video = (*videos)[position];
+            card->onFocusDwell = [video]() {
+                Data::NetworkClient::instance().prefetchStream(std::string(video->id));
+            };
+        }
+
+        // Ask for the next page while the last two rows come into view
+        if (index.row + 2 >= numberOfRows(recycler, index.section)) {
+            auto nearEnd = onNearEnd;
+            brls::sync([nearEnd]() { nearEnd(); });
+        }
+
+        return cell;
+    }
+
+} // namespace Presentation
+} // namespace DarkTube
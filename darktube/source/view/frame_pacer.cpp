@@ -0,0 +1,64 @@
+#include "view/frame_pacer.hpp"
+#include <cmath>
+#include <thread>
+#include <vector>
+#include <borealis.hpp>
+
+// How often input is checked while sleeping out an idle frame
+static constexpr std::chrono::milliseconds PollInterval{4};
+static constexpr float StickDeadzone = 0.2f;
+
+void FramePacer::pace() {
+    if (!enabled) return;
+
+    Clock::time_point now = Clock::now();
+    if (woken.exchange(false) | pollActivity()) lastActivity = now;
+
+    bool wasIdle = idle;
+    idle = now - lastActivity >= IdleAfter;
+    if (idle != wasIdle) brls::Logger::debug("FramePacer: {}", idle ? "idle" : "active");
+
+    if (idle) {
+        // Sleep out the rest of the idle frame, cut short by input or a wake()
+        Clock::time_point deadline = lastFrame + std::chrono::duration_cast<Clock::duration>(idleFrameTime);
+        while (Clock::now() < deadline) {
+            std::this_thread::sleep_for(PollInterval);
+            if (woken.exchange(false) | pollActivity()) {
+                lastActivity = Clock::now();
+                idle = false;
+                brls::Logger::debug("FramePacer: active");
+                break;
+            }
+        }
+    }
+    lastFrame = Clock::now();
+}
+
+void FramePacer::setEnabled(bool enabled) {
+    this->enabled = enabled;
+    idle = false;
+    lastActivity = Clock::now();
+    brls::Logger::info("FramePacer: idle frame pacing {}", enabled ? "on" : "off");
+}
+
+bool FramePacer::pollActivity() {
+    bool active = false;
+
+    brls::View* focus = brls::Application::getCurrentFocus();
+    if (focus != lastFocus) {
+        lastFocus = focus;
+        active = true;
+    }
+
+    brls::InputManager* input = brls::Application::getPlatform()->getInputManager();
+    brls::ControllerState controller{};
+    input->updateUnifiedControllerState(&controller);
+    for (bool pressed : controller.buttons) active |= pressed;
+    for (float axis : controller.axes) active |= std::fabs(axis) > StickDeadzone;
+
+    std::vector<brls::RawTouchState> touches;
+    input->updateTouchStates(&touches);
+    for (const auto& touch : touches) active |= touch.pressed;
+
+    return active;
+}
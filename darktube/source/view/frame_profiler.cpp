@@ -0,0 +1,105 @@
+#include "view/frame_profiler.hpp"
+#include <cstdio>
+#include <borealis/core/logger.hpp>
+
+static double msBetween(FrameProfiler::Clock::time_point from, FrameProfiler::Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+FrameProfiler::Scope::Scope(Phase phase) : phase(phase), start(Clock::now()) {
+    FrameProfiler& profiler = FrameProfiler::instance();
+    parent = profiler.activeScope;
+    profiler.activeScope = this;
+}
+
+FrameProfiler::Scope::~Scope() {
+    FrameProfiler& profiler = FrameProfiler::instance();
+    double elapsed = msBetween(start, Clock::now());
+    profiler.current.phaseMs[phase] += (float)(elapsed - childMs);
+    if (parent) parent->childMs += elapsed;
+    profiler.activeScope = parent;
+}
+
+void FrameProfiler::beginFrame() {
+    current = Frame();
+    current.index = frameCount;
+    frameStart = Clock::now();
+}
+
+void FrameProfiler::endFrame() {
+    Clock::time_point now = Clock::now();
+    // FramePacer's sleep is deliberate, not work: counting it would make an idle UI
+    // at 15 fps look like a run of janky frames
+    float elapsed = (float)msBetween(frameStart, now);
+    current.totalMs = elapsed > current.phaseMs[Idle] ? elapsed - current.phaseMs[Idle] : 0;
+
+    float covered = 0;
+    for (int phase = 0; phase < Other; phase++) {
+        if (phase != Idle) covered += current.phaseMs[phase];
+    }
+    current.phaseMs[Other] = current.totalMs > covered ? current.totalMs - covered : 0;
+
+    // The press is on screen once a frame drawn after it has been swapped in
+    if (inputPending && lastDrawn >= inputTime) {
+        current.inputLatencyMs = (float)msBetween(inputTime, now);
+        lastInputLatencyMs = current.inputLatencyMs;
+        inputPending = false;
+    }
+
+    frames[frameCount % Capacity] = current;
+    frameCount++;
+}
+
+void FrameProfiler::markInput() {
+    // Several presses before a frame lands count from the first
+    if (inputPending) return;
+    inputPending = true;
+    inputTime = Clock::now();
+}
+
+std::vector<FrameProfiler::Frame> FrameProfiler::getFrames() const {
+    std::vector<Frame> result;
+    size_t count = frameCount < Capacity ? (size_t)frameCount : Capacity;
+    result.reserve(count);
+    for (uint64_t i = frameCount - count; i < frameCount; i++) result.push_back(frames[i % Capacity]);
+    return result;
+}
+
+bool FrameProfiler::dump(const std::string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        brls::Logger::error("FrameProfiler: cannot write {}", path);
+        return false;
+    }
+
+    fprintf(file, "frame,total_ms");
+    for (int phase = 0; phase < PhaseCount; phase++) fprintf(file, ",%s_ms", phaseName((Phase)phase));
+    fprintf(file, ",input_latency_ms\n");
+
+    std::vector<Frame> buffered = getFrames();
+    for (const Frame& frame : buffered) {
+        fprintf(file, "%llu,%.3f", (unsigned long long)frame.index, frame.totalMs);
+        for (int phase = 0; phase < PhaseCount; phase++) fprintf(file, ",%.3f", frame.phaseMs[phase]);
+        if (frame.inputLatencyMs >= 0) {
+            fprintf(file, ",%.3f\n", frame.inputLatencyMs);
+        } else {
+            fprintf(file, ",\n");
+        }
+    }
+    fclose(file);
+
+    brls::Logger::info("FrameProfiler: wrote {} frames to {}", buffered.size(), path);
+    return true;
+}
+
+const char* FrameProfiler::phaseName(Phase phase) {
+    switch (phase) {
+        case Sync: return "sync";
+        case Draw: return "draw";
+        case Video: return "video";
+        case Uploads: return "uploads";
+        case Idle: return "idle";
+        case Other: return "other";
+        default: return "?";
+    }
+}
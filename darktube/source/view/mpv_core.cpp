@@ -2,9 +2,21 @@
 #include <cstdlib>
 #include <clocale>
 #include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
 #include <borealis/core/thread.hpp>
 #include <borealis/core/application.hpp>
 #include "view/mpv_core.hpp"
+#include "view/frame_profiler.hpp"
+#include "view/frame_pacer.hpp"
+
+#ifdef __SWITCH__
+#include <switch.h>
+#define CACHE_DIR "sdmc:/darktube_cache"
+#else
+#define CACHE_DIR "darktube_cache"
+#endif
 
 static inline void check_error(int status) {
     if (status < 0) {
@@ -12,6 +24,34 @@ static inline void check_error(int status) {
     }
 }
 
+// reply_userdata passed to mpv_observe_property, used to dispatch property changes
+enum ObservedProperty : uint64_t {
+    PROPERTY_CORE_IDLE = 1,
+    PROPERTY_EOF_REACHED = 2,
+    PROPERTY_DURATION = 3,
+    PROPERTY_TIME_POS = 4,
+    PROPERTY_PAUSE = 12,
+    PROPERTY_PAUSED_FOR_CACHE = 13,
+    PROPERTY_DEMUXER_CACHE_STATE = 14,
+    PROPERTY_CACHE_SPEED = 15,
+    PROPERTY_PLAYLIST_POS = 16,
+};
+
+// Bits of publishedFlags
+static constexpr uint32_t STATE_STOPPED = 1 << 0;
+static constexpr uint32_t STATE_PLAYING = 1 << 1;
+static constexpr uint32_t STATE_BUFFERING = 1 << 2;
+static constexpr uint32_t STATE_EOF = 1 << 3;
+static constexpr uint32_t STATE_CACHE_IDLE = 1 << 4;
+
+// A seamless switch waits until the new stream has this much cached past the position,
+static constexpr double SwitchAheadSec = 3;
+// and reloads in place instead if that takes longer than this
+static constexpr double SwitchTimeoutSec = 20;
+// Seeks in the old stream further than this from the standby's cache are followed
+static constexpr double SwitchFollowSec = 30;
+static constexpr std::chrono::milliseconds SwitchPollInterval{100};
+
 static void *get_proc_address(void *unused, const char *name) {
 #ifdef __SDL2__
     SDL_GL_GetCurrentContext();
@@ -22,35 +62,7 @@ static void *get_proc_address(void *unused, const char *name) {
 #endif
 }
 
-void MPVCore::on_update(void *self) {
-    brls::sync([]() {
-        uint64_t flags = mpv_render_context_update(MPVCore::instance().getContext());
-        MPVCore::instance().redraw = (flags & MPV_RENDER_UPDATE_FRAME) != 0;
-    });
-}
-
-void MPVCore::on_wakeup(void *self) {
-    brls::sync([]() { MPVCore::instance().eventMainLoop(); });
-}
-
-MPVCore::MPVCore() {
-    this->init();
-
-    exitDoneEventSubscription = brls::Application::getExitDoneEvent()->subscribe([this]() {
-        this->clean();
-    });
-}
-
-MPVCore::~MPVCore() = default;
-
-void MPVCore::init() {
-    brls::Logger::info("MPVCore::init started");
-    setlocale(LC_NUMERIC, "C");
-    this->mpv = mpv_create();
-    if (!mpv) {
-        brls::fatal("Error Create mpv Handle");
-    }
-
+static void setOptions(mpv_handle *mpv) {
     mpv_set_option_string(mpv, "ytdl", "no");
     mpv_set_option_string(mpv, "audio-channels", "stereo");
     mpv_set_option_string(mpv, "idle", "yes");
@@ -71,36 +83,119 @@ void MPVCore::init() {
 #endif
 
     mpv_set_option_string(mpv, "cache", "yes");
-    mpv_set_option_string(mpv, "demuxer-max-bytes", "12MiB");
-    mpv_set_option_string(mpv, "demuxer-max-back-bytes", "5MiB");
+    mpv_set_option_string(mpv, "prefetch-playlist", "yes");
+    // Only used by the disk cache profile; renamed demuxer-cache-dir in newer mpv
+    if (mpv_set_option_string(mpv, "cache-dir", CACHE_DIR) < 0) {
+        mpv_set_option_string(mpv, "demuxer-cache-dir", CACHE_DIR);
+    }
     mpv_set_option_string(mpv, "demuxer-lavf-analyzeduration", "0.4");
     mpv_set_option_string(mpv, "demuxer-lavf-probescore", "24");
 
     mpv_set_option_string(mpv, "terminal", "yes");
     mpv_set_option_string(mpv, "msg-level", "all=v");
+}
 
-    if (mpv_initialize(mpv) < 0) {
-        mpv_terminate_destroy(mpv);
-        brls::fatal("Could not initialize mpv context");
-    }
+// Options, so they apply from the next loadfile on
+static void applyCacheProfile(mpv_handle *mpv, const DarkTube::Domain::CacheProfile &profile) {
+    mpv_set_option_string(mpv, "demuxer-max-bytes", std::to_string(profile.maxBytes).c_str());
+    mpv_set_option_string(mpv, "demuxer-max-back-bytes", std::to_string(profile.maxBackBytes).c_str());
+    mpv_set_option_string(mpv, "cache-on-disk", profile.onDisk ? "yes" : "no");
+}
 
-    check_error(mpv_request_log_messages(mpv, "debug"));
-    check_error(mpv_observe_property(mpv, 1, "core-idle", MPV_FORMAT_FLAG));
-    check_error(mpv_observe_property(mpv, 2, "eof-reached", MPV_FORMAT_FLAG));
-    check_error(mpv_observe_property(mpv, 3, "duration", MPV_FORMAT_DOUBLE));
-    check_error(mpv_observe_property(mpv, 4, "time-pos", MPV_FORMAT_DOUBLE));
-    check_error(mpv_observe_property(mpv, 12, "pause", MPV_FORMAT_FLAG));
-    check_error(mpv_observe_property(mpv, 13, "paused-for-cache", MPV_FORMAT_FLAG)); // Observe buffering state
-
-    // Create render context for OpenGL
+static void observeProperties(mpv_handle *mpv) {
+    check_error(mpv_observe_property(mpv, PROPERTY_CORE_IDLE, "core-idle", MPV_FORMAT_FLAG));
+    check_error(mpv_observe_property(mpv, PROPERTY_EOF_REACHED, "eof-reached", MPV_FORMAT_FLAG));
+    check_error(mpv_observe_property(mpv, PROPERTY_DURATION, "duration", MPV_FORMAT_DOUBLE));
+    check_error(mpv_observe_property(mpv, PROPERTY_TIME_POS, "time-pos", MPV_FORMAT_DOUBLE));
+    check_error(mpv_observe_property(mpv, PROPERTY_PAUSE, "pause", MPV_FORMAT_FLAG));
+    check_error(mpv_observe_property(mpv, PROPERTY_PAUSED_FOR_CACHE, "paused-for-cache", MPV_FORMAT_FLAG)); // Observe buffering state
+    check_error(mpv_observe_property(mpv, PROPERTY_DEMUXER_CACHE_STATE, "demuxer-cache-state", MPV_FORMAT_NODE));
+    check_error(mpv_observe_property(mpv, PROPERTY_CACHE_SPEED, "cache-speed", MPV_FORMAT_INT64));
+    check_error(mpv_observe_property(mpv, PROPERTY_PLAYLIST_POS, "playlist-pos", MPV_FORMAT_INT64));
+}
+
+static bool createRenderContext(mpv_handle *mpv, mpv_render_context **context) {
     int advanced_control{1};
     mpv_opengl_init_params gl_init_params{get_proc_address, nullptr};
     mpv_render_param params[]{{MPV_RENDER_PARAM_API_TYPE, const_cast<char *>(MPV_RENDER_API_TYPE_OPENGL)},
                               {MPV_RENDER_PARAM_OPENGL_INIT_PARAMS, &gl_init_params},
                               {MPV_RENDER_PARAM_ADVANCED_CONTROL, &advanced_control},
                               {MPV_RENDER_PARAM_INVALID, nullptr}};
+    return mpv_render_context_create(context, mpv, params) >= 0;
+}
 
-    if (mpv_render_context_create(&mpv_context, mpv, params) < 0) {
+// Queues the next video behind the current one. "start" is global and is left at a
+// seek position by reloads and standby players, so the entry brings its own (a per-file
+// option: the third loadfile argument in mpv 0.36, after an index from 0.38 on).
+static void appendNext(mpv_handle *mpv, const std::string &url) {
+    const char *cmd[] = {"loadfile", url.c_str(), "append", "start=0", NULL};
+    check_error(mpv_command_async(mpv, 0, cmd));
+}
+
+// End of the demuxed range, in stream seconds; 0 while nothing is cached
+static double cacheEndOf(mpv_handle *mpv) {
+    mpv_node node;
+    if (mpv_get_property(mpv, "demuxer-cache-state", MPV_FORMAT_NODE, &node) < 0) return 0;
+    double end = 0;
+    if (node.format == MPV_FORMAT_NODE_MAP) {
+        for (int i = 0; i < node.u.list->num; i++) {
+            const mpv_node &value = node.u.list->values[i];
+            if (strcmp(node.u.list->keys[i], "cache-end") == 0 && value.format == MPV_FORMAT_DOUBLE) {
+                end = value.u.double_;
+            }
+        }
+    }
+    mpv_free_node_contents(&node);
+    return end;
+}
+
+// Called from mpv's threads. The flag is cleared before the task does its work, so a
+// signal that arrives meanwhile queues a fresh task instead of being lost.
+void MPVCore::on_update(void *self) {
+    auto *core = (MPVCore *)self;
+    core->updateSignals.fetch_add(1, std::memory_order_relaxed);
+    if (core->updatePending.exchange(true)) return;
+    core->updatePosts.fetch_add(1, std::memory_order_relaxed);
+    brls::sync([core]() {
+        core->updatePending.store(false);
+        // Flags accumulate in mpv until read, so coalesced updates aren't lost
+        uint64_t flags = mpv_render_context_update(core->getContext());
+        core->redraw = (flags & MPV_RENDER_UPDATE_FRAME) != 0;
+        if (core->redraw) FramePacer::instance().wake(); // a paused video sends none
+        core->reportCallbackStats();
+    });
+}
+
+MPVCore::MPVCore() {
+    this->init();
+
+    exitDoneEventSubscription = brls::Application::getExitDoneEvent()->subscribe([this]() {
+        this->clean();
+    });
+}
+
+MPVCore::~MPVCore() = default;
+
+void MPVCore::init() {
+    brls::Logger::info("MPVCore::init started");
+    setlocale(LC_NUMERIC, "C");
+    this->mpv = mpv_create();
+    if (!mpv) {
+        brls::fatal("Error Create mpv Handle");
+    }
+
+    setOptions(mpv);
+    applyCacheProfile(mpv, cacheProfile);
+
+    if (mpv_initialize(mpv) < 0) {
+        mpv_terminate_destroy(mpv);
+        brls::fatal("Could not initialize mpv context");
+    }
+
+    check_error(mpv_request_log_messages(mpv, "debug"));
+    observeProperties(mpv);
+
+    if (!createRenderContext(mpv, &mpv_context)) {
         mpv_terminate_destroy(mpv);
         brls::fatal("failed to initialize mpv render context");
     }
@@ -109,9 +204,13 @@ void MPVCore::init() {
     brls::Logger::info("FFMPEG Version: {}", mpv_get_property_string(mpv, "ffmpeg-version"));
 
     setVolume(100);
-    mpv_set_wakeup_callback(mpv, on_wakeup, this);
     mpv_render_context_set_update_callback(mpv_context, on_update, this);
 
+    // Events (log lines, time-pos several times a second) are handled off the UI thread
+    publishState(); // stopped, until a file loads; nothing else writes yet
+    eventThreadRunning = true;
+    eventThread = std::thread(&MPVCore::eventLoop, this);
+
     focusSubscription = brls::Application::getWindowFocusChangedEvent()->subscribe([this](bool focus) {
         if (focus) {
             if (isPlaying()) resume();
@@ -126,8 +225,21 @@ void MPVCore::init() {
 }
 
 void MPVCore::clean() {
+    if (this->standbyContext) {
+        mpv_render_context_free(this->standbyContext);
+        this->standbyContext = nullptr;
+    }
+    if (this->standby) {
+        mpv_terminate_destroy(this->standby);
+        this->standby = nullptr;
+    }
     mpv_command_string(this->mpv, "quit");
     brls::Application::getWindowFocusChangedEvent()->unsubscribe(focusSubscription);
+    if (eventThread.joinable()) {
+        eventThreadRunning = false;
+        mpv_wakeup(this->mpv);
+        eventThread.join();
+    }
     if (this->mpv_context) {
         mpv_render_context_free(this->mpv_context);
         this->mpv_context = nullptr;
@@ -138,15 +250,258 @@ void MPVCore::clean() {
     }
 }
 
-void MPVCore::setUrl(const std::string &url, const std::string &audioUrl) {
+void MPVCore::setUrl(const std::string &url, const std::string &audioUrl, double startSeconds) {
     if (!mpv) return;
-    this->eof_reached = false;
-    
-    // Store audio URL to add after file loads
-    this->pendingAudioUrl = audioUrl;
-    
+    std::string next;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        state.eof = false;
+        // Store audio URL to add after file loads
+        this->pendingAudioUrl = audioUrl;
+        next = nextUrl;
+        publishState();
+    }
+
+    // "start" is an option that outlives the file, so every load sets it
+    std::string start = startSeconds > 0 ? std::to_string(startSeconds) : "none";
+    check_error(mpv_set_property_string(mpv, "start", start.c_str()));
+
     const char *cmd[] = {"loadfile", url.c_str(), "replace", NULL};
     check_error(mpv_command_async(mpv, 0, cmd));
+    // "replace" empties the playlist
+    if (!next.empty()) {
+        appendNext(mpv, next);
+    }
+}
+
+void MPVCore::queueNext(const std::string &url) {
+    if (!mpv) return;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        nextUrl = url;
+    }
+    // A pending quality switch takes its playlist along when it swaps in
+    for (mpv_handle *handle : {mpv, standby}) {
+        if (!handle) continue;
+        mpv_command_string(handle, "playlist-clear"); // everything but the current file
+        if (url.empty()) continue;
+        appendNext(handle, url);
+    }
+}
+
+void MPVCore::setCacheProfile(const DarkTube::Domain::CacheProfile &profile) {
+    cacheProfile = profile;
+    if (profile.onDisk) mkdir(CACHE_DIR, 0777);
+    if (mpv) applyCacheProfile(mpv, profile);
+    brls::Logger::info("MPV: Cache profile {}: {} MiB ahead, {} MiB behind{}", profile.name, profile.maxBytes / DarkTube::Domain::CacheProfile::MiB,
+                       profile.maxBackBytes / DarkTube::Domain::CacheProfile::MiB, profile.onDisk ? ", on disk" : "");
+}
+
+uint64_t MPVCore::getAvailableMemory() {
+#if defined(__SWITCH__)
+    uint64_t total = 0, used = 0;
+    if (R_FAILED(svcGetInfo(&total, InfoType_TotalMemorySize, CUR_PROCESS_HANDLE, 0))) return 0;
+    if (R_FAILED(svcGetInfo(&used, InfoType_UsedMemorySize, CUR_PROCESS_HANDLE, 0))) return 0;
+    return total > used ? total - used : 0;
+#elif defined(__linux__)
+    // MemAvailable counts reclaimable page cache, unlike sysconf's free pages
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    uint64_t kib;
+    while (meminfo >> key >> kib) {
+        if (key == "MemAvailable:") return kib * 1024;
+        meminfo.ignore(256, '\n');
+    }
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+void MPVCore::switchUrl(const std::string &url, const std::string &audioUrl, bool seamless) {
+    if (!mpv) return;
+    dropStandby();
+    switchStartedAt = std::chrono::steady_clock::now();
+    switchTarget = url;
+    switchAudio = audioUrl;
+
+    PlaybackState current = getState();
+    if (seamless && !current.stopped && !current.eof && startStandby(url, audioUrl, current.time)) {
+        brls::Logger::info("MPV: Buffering new stream from {:.1f}s before switching", current.time);
+        return;
+    }
+    reload(url, audioUrl);
+}
+
+// Replaces the file in place at the current position; playback waits for it to buffer
+void MPVCore::reload(const std::string &url, const std::string &audioUrl) {
+    PlaybackState current = getState();
+    switchMode = SWITCH_RELOAD;
+    switchLoads = fileLoads.load();
+    setUrl(url, audioUrl, current.eof ? 0 : current.time);
+    resume();
+}
+
+// mpv can't buffer a second file in the same handle, so the new stream gets a player of
+// its own: paused and muted, starting at the current position
+bool MPVCore::startStandby(const std::string &url, const std::string &audioUrl, double startSeconds) {
+    standby = mpv_create();
+    if (!standby) return false;
+
+    setOptions(standby);
+    applyCacheProfile(standby, cacheProfile);
+    mpv_set_option_string(standby, "pause", "yes");
+    mpv_set_option_string(standby, "mute", "yes");
+    mpv_set_option_string(standby, "start", std::to_string(startSeconds).c_str());
+    // vo=libmpv needs a render context before the video can be decoded at all
+    if (mpv_initialize(standby) < 0 || !createRenderContext(standby, &standbyContext)) {
+        brls::Logger::error("MPV: Could not create standby player");
+        dropStandby();
+        return false;
+    }
+
+    const char *cmd[] = {"loadfile", url.c_str(), "replace", NULL};
+    if (mpv_command_async(standby, 0, cmd) < 0) {
+        dropStandby();
+        return false;
+    }
+    std::string next;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        next = nextUrl;
+    }
+    if (!next.empty()) {
+        appendNext(standby, next);
+    }
+    switchMode = SWITCH_STANDBY;
+    standbyStart = startSeconds;
+    standbyLoaded = false;
+    switchPolledAt = std::chrono::steady_clock::time_point();
+    return true;
+}
+
+void MPVCore::updateSwitch() {
+    if (switchMode == SWITCH_NONE) return;
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - switchStartedAt).count();
+    PlaybackState current = getState();
+
+    if (switchMode == SWITCH_RELOAD) {
+        if (fileLoads.load() == switchLoads || !current.playing || current.buffering) return;
+        brls::Logger::info("MPV: Quality switch took {:.0f} ms (reload)", elapsed * 1000);
+        switchMode = SWITCH_NONE;
+        return;
+    }
+
+    if (now - switchPolledAt < SwitchPollInterval) return;
+    switchPolledAt = now;
+
+    if (current.stopped || current.eof) {
+        brls::Logger::info("MPV: Playback ended, quality switch cancelled");
+        dropStandby();
+        return;
+    }
+    bool failed = !pollStandby();
+    if (failed || elapsed > SwitchTimeoutSec) {
+        brls::Logger::warning("MPV: Standby stream {} after {:.1f}s, reloading instead", failed ? "failed" : "timed out", elapsed);
+        dropStandby();
+        reload(switchTarget, switchAudio);
+        return;
+    }
+    if (!standbyLoaded) return;
+
+    double cacheEnd = cacheEndOf(standby);
+    if (cacheEnd <= 0) return;
+    if (current.time < standbyStart - 1 || current.time > cacheEnd + SwitchFollowSec) {
+        std::string time = std::to_string(current.time);
+        const char *cmd[] = {"seek", time.c_str(), "absolute", NULL};
+        check_error(mpv_command_async(standby, 0, cmd));
+        standbyStart = current.time;
+        return;
+    }
+    if (cacheEnd >= current.time + SwitchAheadSec) swapInStandby(cacheEnd);
+}
+
+// Drains the standby's events; false once its file failed to load
+bool MPVCore::pollStandby() {
+    while (true) {
+        mpv_event *event = mpv_wait_event(standby, 0);
+        switch (event->event_id) {
+            case MPV_EVENT_NONE:
+                return true;
+            case MPV_EVENT_FILE_LOADED:
+                standbyLoaded = true;
+                if (!switchAudio.empty()) {
+                    const char *audio_cmd[] = {"audio-add", switchAudio.c_str(), "select", NULL};
+                    check_error(mpv_command_async(standby, 0, audio_cmd));
+                }
+                break;
+            case MPV_EVENT_END_FILE:
+                if (((mpv_event_end_file *)event->data)->reason == MPV_END_FILE_REASON_ERROR) return false;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void MPVCore::swapInStandby(double cacheEnd) {
+    PlaybackState current = getState();
+
+    // Pick up exactly where the old stream is; the target is already in the cache
+    std::string time = std::to_string(current.time);
+    const char *cmd[] = {"seek", time.c_str(), "absolute+exact", NULL};
+    check_error(mpv_command(standby, cmd));
+    // The old player runs until it's torn down after the swap; silence it first so the
+    // two never play together
+    mpv_set_property_string(mpv, "pause", "yes");
+    mpv_set_property_string(mpv, "mute", "yes");
+    mpv_set_property_string(standby, "mute", "no");
+    mpv_set_property_string(standby, "pause", current.isPaused() ? "yes" : "no");
+
+    // The event thread waits on this->mpv, so it sits out the exchange
+    eventThreadRunning = false;
+    mpv_wakeup(mpv);
+    eventThread.join();
+
+    mpv_render_context_set_update_callback(mpv_context, nullptr, nullptr);
+    std::swap(mpv, standby);
+    std::swap(mpv_context, standbyContext);
+    mpv_render_context_set_update_callback(mpv_context, on_update, this);
+    rect = brls::Rect(); // video margins are per handle; the next draw sets them again
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        state.stopped = false;
+        state.eof = false;
+        pendingAudioUrl.clear();
+        publishState();
+    }
+    // Observing sends the current values as change events
+    check_error(mpv_request_log_messages(mpv, "debug"));
+    observeProperties(mpv);
+    eventThreadRunning = true;
+    eventThread = std::thread(&MPVCore::eventLoop, this);
+
+    dropStandby(); // now the old player
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - switchStartedAt).count();
+    brls::Logger::info("MPV: Quality switch took {:.0f} ms (seamless, {:.1f}s buffered ahead)", elapsed * 1000, cacheEnd - current.time);
+}
+
+// Ends any pending switch and frees the standby player
+void MPVCore::dropStandby() {
+    switchMode = SWITCH_NONE;
+    standbyLoaded = false;
+    if (standbyContext) {
+        mpv_render_context_free(standbyContext);
+        standbyContext = nullptr;
+    }
+    if (standby) {
+        // Waits for mpv's threads, so not on the UI thread
+        mpv_handle *handle = standby;
+        standby = nullptr;
+        brls::async([handle]() { mpv_terminate_destroy(handle); });
+    }
 }
 
 void MPVCore::setFrameSize(brls::Rect r) {
@@ -171,7 +526,10 @@ void MPVCore::draw(brls::Rect area, float alpha) {
     if (!(this->rect == area)) setFrameSize(area);
 
     if (alpha >= 1) {
-        mpv_render_context_render(this->mpv_context, mpv_params);
+        {
+            FrameProfiler::Scope scope(FrameProfiler::Video);
+            mpv_render_context_render(this->mpv_context, mpv_params);
+        }
         glBindFramebuffer(GL_FRAMEBUFFER, default_framebuffer);
         glViewport(0, 0, brls::Application::windowWidth, brls::Application::windowHeight);
         mpv_render_context_report_swap(this->mpv_context);
@@ -191,74 +549,236 @@ void MPVCore::draw(brls::Rect area, float alpha) {
     }
 }
 
-void MPVCore::eventMainLoop() {
-    while (true) {
-        auto event = mpv_wait_event(this->mpv, 0);
+void MPVCore::eventLoop() {
+    while (eventThreadRunning) {
+        auto event = mpv_wait_event(this->mpv, -1);
         switch (event->event_id) {
-            case MPV_EVENT_NONE:
+            case MPV_EVENT_NONE: // woken up by clean()
+                break;
+            case MPV_EVENT_SHUTDOWN:
                 return;
             case MPV_EVENT_LOG_MESSAGE: {
                 auto *msg = (mpv_event_log_message *)event->data;
                 brls::Logger::info("[MPV] [{}] {}: {}", msg->prefix, msg->level, msg->text);
                 break;
             }
-            case MPV_EVENT_PROPERTY_CHANGE: {
-                auto *prop = (mpv_event_property *)event->data;
-                if (strcmp(prop->name, "core-idle") == 0 && prop->format == MPV_FORMAT_FLAG) {
-                    int idle = *(int *)prop->data;
-                    video_playing = !idle;
-                } else if (strcmp(prop->name, "paused-for-cache") == 0 && prop->format == MPV_FORMAT_FLAG) {
-                    int cache_paused = *(int *)prop->data;
-                    buffering = !!cache_paused;
-                } else if (strcmp(prop->name, "eof-reached") == 0 && prop->format == MPV_FORMAT_FLAG) {
-                    eof_reached = *(int *)prop->data;
-                    if (eof_reached) brls::Logger::info("EOF Reached");
-                } else if (strcmp(prop->name, "pause") == 0 && prop->format == MPV_FORMAT_FLAG) {
-                    int is_paused = *(int *)prop->data;
-                    video_playing = !is_paused;
-                } else if (strcmp(prop->name, "duration") == 0 && prop->format == MPV_FORMAT_DOUBLE) {
-                    duration = *(double *)prop->data;
-                } else if (strcmp(prop->name, "time-pos") == 0 && prop->format == MPV_FORMAT_DOUBLE) {
-                    playback_time = *(double *)prop->data;
-                }
+            case MPV_EVENT_PROPERTY_CHANGE:
+                handleProperty((mpv_event_property *)event->data, event->reply_userdata);
                 break;
-            }
-            case MPV_EVENT_FILE_LOADED:
-                video_stopped = false;
+            case MPV_EVENT_FILE_LOADED: {
+                fileLoads.fetch_add(1);
+                gapLoaded = true;
+                std::string audioUrl;
+                {
+                    std::lock_guard<std::mutex> lock(stateMutex);
+                    state.stopped = false;
+                    audioUrl.swap(pendingAudioUrl);
+                    publishState();
+                }
                 // Add external audio track if pending
-                if (!pendingAudioUrl.empty()) {
-                    brls::Logger::info("MPV: Adding external audio: {}", pendingAudioUrl);
-                    const char *audio_cmd[] = {"audio-add", pendingAudioUrl.c_str(), "select", NULL};
+                if (!audioUrl.empty()) {
+                    brls::Logger::info("MPV: Adding external audio: {}", audioUrl);
+                    const char *audio_cmd[] = {"audio-add", audioUrl.c_str(), "select", NULL};
                     check_error(mpv_command_async(mpv, 0, audio_cmd));
-                    pendingAudioUrl.clear();
                 }
                 break;
+            }
             case MPV_EVENT_END_FILE: {
-                video_stopped = true;
-                video_playing = false;
+                if (((mpv_event_end_file *)event->data)->reason == MPV_END_FILE_REASON_EOF) startGap();
+                std::lock_guard<std::mutex> lock(stateMutex);
+                state.stopped = true;
+                state.playing = false;
+                publishState();
                 break;
             }
+            case MPV_EVENT_PLAYBACK_RESTART:
+                // A restart without a load in between was a seek back into the same video
+                if (gapPending && gapLoaded) {
+                    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - gapStartedAt).count();
+                    lastGapMs.store(ms);
+                    brls::Logger::info("MPV: Gap between videos: {:.0f} ms", ms);
+                }
+                gapPending = false;
+                break;
             default:
                 break;
         }
     }
 }
 
+void MPVCore::handleProperty(mpv_event_property *prop, uint64_t id) {
+    // Unavailable properties (time-pos with nothing loaded) keep their last value
+    if (prop->format == MPV_FORMAT_NONE) return;
+
+    std::lock_guard<std::mutex> lock(stateMutex);
+    switch (id) {
+        case PROPERTY_CORE_IDLE:
+            state.playing = !*(int *)prop->data;
+            break;
+        case PROPERTY_PAUSED_FOR_CACHE:
+            state.buffering = *(int *)prop->data;
+            break;
+        case PROPERTY_EOF_REACHED:
+            state.eof = *(int *)prop->data;
+            if (state.eof) {
+                brls::Logger::info("EOF Reached");
+                startGap();
+            }
+            break;
+        case PROPERTY_PAUSE:
+            state.playing = !*(int *)prop->data;
+            break;
+        case PROPERTY_DURATION:
+            state.duration = *(double *)prop->data;
+            break;
+        case PROPERTY_TIME_POS:
+            state.time = *(double *)prop->data;
+            break;
+        case PROPERTY_DEMUXER_CACHE_STATE: {
+            auto *node = (mpv_node *)prop->data;
+            if (node->format != MPV_FORMAT_NODE_MAP) return;
+            for (int i = 0; i < node->u.list->num; i++) {
+                const char *key = node->u.list->keys[i];
+                const mpv_node &value = node->u.list->values[i];
+                if (strcmp(key, "cache-duration") == 0 && value.format == MPV_FORMAT_DOUBLE) {
+                    state.cacheSeconds = value.u.double_;
+                } else if (strcmp(key, "raw-input-rate") == 0 && value.format == MPV_FORMAT_INT64) {
+                    state.inputBytesPerSec = (double)value.u.int64;
+                } else if (strcmp(key, "idle") == 0 && value.format == MPV_FORMAT_FLAG) {
+                    state.cacheIdle = value.u.flag;
+                } else if (strcmp(key, "total-bytes") == 0 && value.format == MPV_FORMAT_INT64) {
+                    state.cacheBytes = (double)value.u.int64;
+                }
+            }
+            break;
+        }
+        case PROPERTY_CACHE_SPEED:
+            state.inputBytesPerSec = (double)*(int64_t *)prop->data;
+            break;
+        case PROPERTY_PLAYLIST_POS:
+            // The playlist is only ever [current, queued], so anything past 0 means mpv
+            // moved on; trim it back so the next queueNext starts from the same shape
+            if (*(int64_t *)prop->data <= 0 || nextUrl.empty()) return;
+            state.playlistItem++;
+            nextUrl.clear();
+            {
+                const char *cmd[] = {"playlist-clear", NULL};
+                check_error(mpv_command_async(mpv, 0, cmd));
+            }
+            break;
+        default:
+            return;
+    }
+    publishState();
+}
+
+// Event thread; the first end of file wins until playback restarts
+void MPVCore::startGap() {
+    if (gapPending) return;
+    gapPending = true;
+    gapLoaded = false;
+    gapStartedAt = std::chrono::steady_clock::now();
+}
+
+// Caller holds stateMutex
+void MPVCore::publishState() {
+    uint32_t flags = (state.stopped ? STATE_STOPPED : 0) | (state.playing ? STATE_PLAYING : 0) |
+                     (state.buffering ? STATE_BUFFERING : 0) | (state.eof ? STATE_EOF : 0) |
+                     (state.cacheIdle ? STATE_CACHE_IDLE : 0);
+    uint64_t version = stateVersion.load(std::memory_order_relaxed);
+    stateVersion.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    publishedFlags.store(flags, std::memory_order_relaxed);
+    publishedTime.store(state.time, std::memory_order_relaxed);
+    publishedDuration.store(state.duration, std::memory_order_relaxed);
+    publishedCacheSeconds.store(state.cacheSeconds, std::memory_order_relaxed);
+    publishedInputRate.store(state.inputBytesPerSec, std::memory_order_relaxed);
+    publishedCacheBytes.store(state.cacheBytes, std::memory_order_relaxed);
+    publishedPlaylistItem.store(state.playlistItem, std::memory_order_relaxed);
+    stateVersion.store(version + 2, std::memory_order_release);
+}
+
+MPVCore::PlaybackState MPVCore::getState() const {
+    PlaybackState snapshot;
+    while (true) {
+        uint64_t version = stateVersion.load(std::memory_order_acquire);
+        if (version & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        uint32_t flags = publishedFlags.load(std::memory_order_relaxed);
+        snapshot.time = publishedTime.load(std::memory_order_relaxed);
+        snapshot.duration = publishedDuration.load(std::memory_order_relaxed);
+        snapshot.cacheSeconds = publishedCacheSeconds.load(std::memory_order_relaxed);
+        snapshot.inputBytesPerSec = publishedInputRate.load(std::memory_order_relaxed);
+        snapshot.cacheBytes = publishedCacheBytes.load(std::memory_order_relaxed);
+        snapshot.playlistItem = publishedPlaylistItem.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (stateVersion.load(std::memory_order_relaxed) != version) continue;
+
+        snapshot.version = version / 2;
+        snapshot.stopped = flags & STATE_STOPPED;
+        snapshot.playing = flags & STATE_PLAYING;
+        snapshot.buffering = flags & STATE_BUFFERING;
+        snapshot.eof = flags & STATE_EOF;
+        snapshot.cacheIdle = flags & STATE_CACHE_IDLE;
+        return snapshot;
+    }
+}
+
 mpv_render_context *MPVCore::getContext() { return this->mpv_context; }
 mpv_handle *MPVCore::getHandle() { return this->mpv; }
 
-bool MPVCore::isStopped() const { return video_stopped; }
-bool MPVCore::isPlaying() const { return video_playing; }
-bool MPVCore::isPaused() const { return !video_playing && !video_stopped; }
-bool MPVCore::isBuffering() const { return buffering; }
+MPVCore::CallbackStats MPVCore::getCallbackStats() const {
+    CallbackStats stats;
+    stats.updateSignals = updateSignals.load(std::memory_order_relaxed);
+    stats.updatePosts = updatePosts.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// Logs, once per second of playback, how many sync tasks coalescing saved
+void MPVCore::reportCallbackStats() {
+    auto now = std::chrono::steady_clock::now();
+    if (!getState().playing) {
+        reportedStats = getCallbackStats();
+        reportedAt = now;
+        return;
+    }
+    double seconds = std::chrono::duration<double>(now - reportedAt).count();
+    if (seconds < 1) return;
+
+    CallbackStats stats = getCallbackStats();
+    uint64_t updates = stats.updateSignals - reportedStats.updateSignals;
+    uint64_t avoided = updates - (stats.updatePosts - reportedStats.updatePosts);
+    brls::Logger::debug("MPV: {:.0f} update signals/s, {:.0f} posts/s avoided", updates / seconds, avoided / seconds);
+    reportedStats = stats;
+    reportedAt = now;
+}
+
+bool MPVCore::isStopped() const { return getState().stopped; }
+bool MPVCore::isPlaying() const { return getState().playing; }
+bool MPVCore::isPaused() const { return getState().isPaused(); }
+bool MPVCore::isBuffering() const { return getState().buffering; }
+bool MPVCore::isEOF() const { return getState().eof; }
 
 void MPVCore::resume() { 
-    video_stopped = false;
-    eof_reached = false;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        state.stopped = false;
+        state.eof = false;
+        publishState();
+    }
     mpv_command_string(mpv, "set pause no"); 
 }
 void MPVCore::pause() { mpv_command_string(mpv, "set pause yes"); }
-void MPVCore::stop() { mpv_command_string(mpv, "stop"); }
+void MPVCore::stop() {
+    dropStandby();
+    {
+        std::lock_guard<std::mutex> lock(stateMutex); // "stop" empties the playlist
+        nextUrl.clear();
+    }
+    mpv_command_string(mpv, "stop");
+}
 void MPVCore::seek(int64_t p) {
     if (!mpv) return;
     const char *cmd[] = {"seek", std::to_string(p).c_str(), "relative", NULL};
@@ -266,8 +786,6 @@ void MPVCore::seek(int64_t p) {
 }
 void MPVCore::restart() {
     if (!mpv) return;
-    video_stopped = false;
-    eof_reached = false;
     const char *cmd[] = {"seek", "0", "absolute", NULL};
     check_error(mpv_command_async(mpv, 0, cmd));
     this->resume();
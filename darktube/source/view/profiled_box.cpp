@@ -0,0 +1,144 @@
+#include "view/profiled_box.hpp"
+#include "view/frame_profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+
+#ifdef __SWITCH__
+#define FRAMES_PATH "sdmc:/darktube_frames.csv"
+#else
+#define FRAMES_PATH "darktube_frames.csv"
+#endif
+
+// Frame time histogram buckets (upper bounds, ms); the last one catches the rest
+static const float BucketLimits[] = {4, 8, 12, 16.7f, 20, 33.3f, 50, 1e9f};
+static const char* BucketLabels[] = {"<4", "<8", "<12", "<16.7", "<20", "<33", "<50", "50+"};
+static constexpr int BucketCount = sizeof(BucketLimits) / sizeof(BucketLimits[0]);
+static constexpr int WorstFrames = 5;
+
+ProfiledBox::ProfiledBox() {
+    this->registerAction("Profiler", brls::BUTTON_RSB, [](brls::View* view) {
+        FrameProfiler& profiler = FrameProfiler::instance();
+        profiler.setOverlayVisible(!profiler.isOverlayVisible());
+        return true;
+    }, true);
+
+    this->registerAction("Dump frames", brls::BUTTON_LSB, [](brls::View* view) {
+        if (FrameProfiler::instance().dump(FRAMES_PATH)) brls::Application::notify("Frame timings saved to " FRAMES_PATH);
+        return true;
+    }, true);
+}
+
+void ProfiledBox::draw(NVGcontext* vg, float x, float y, float width, float height, brls::Style style, brls::FrameContext* ctx) {
+    {
+        FrameProfiler::Scope scope(FrameProfiler::Draw);
+        Box::draw(vg, x, y, width, height, style, ctx);
+    }
+    FrameProfiler::instance().markDrawn();
+
+    // Not timed: it would only measure itself
+    if (FrameProfiler::instance().isOverlayVisible()) drawOverlay(vg, x, y, width);
+}
+
+void ProfiledBox::drawOverlay(NVGcontext* vg, float x, float y, float width) {
+    FrameProfiler& profiler = FrameProfiler::instance();
+    std::vector<FrameProfiler::Frame> frames = profiler.getFrames();
+    if (frames.empty()) return;
+
+    // Totals, per-phase averages/maxima and the histogram over the whole buffer
+    std::vector<float> totals;
+    totals.reserve(frames.size());
+    float phaseSum[FrameProfiler::PhaseCount] = {};
+    float phaseMax[FrameProfiler::PhaseCount] = {};
+    int buckets[BucketCount] = {};
+    for (const auto& frame : frames) {
+        totals.push_back(frame.totalMs);
+        for (int phase = 0; phase < FrameProfiler::PhaseCount; phase++) {
+            phaseSum[phase] += frame.phaseMs[phase];
+            phaseMax[phase] = std::max(phaseMax[phase], frame.phaseMs[phase]);
+        }
+        int bucket = 0;
+        while (bucket < BucketCount - 1 && frame.totalMs >= BucketLimits[bucket]) bucket++;
+        buckets[bucket]++;
+    }
+    std::vector<float> sorted = totals;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](float p) { return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))]; };
+
+    std::vector<const FrameProfiler::Frame*> worst;
+    for (const auto& frame : frames) worst.push_back(&frame);
+    size_t worstCount = std::min((size_t)WorstFrames, worst.size());
+    std::partial_sort(worst.begin(), worst.begin() + worstCount, worst.end(),
+        [](const FrameProfiler::Frame* a, const FrameProfiler::Frame* b) { return a->totalMs > b->totalMs; });
+
+    const float panelWidth = 460;
+    const float lineHeight = 20;
+    const float histogramHeight = 70;
+    const float panelHeight = lineHeight * (4 + FrameProfiler::PhaseCount + worstCount) + histogramHeight + 40;
+    const float left = x + width - panelWidth - 20;
+    float top = y + 20;
+
+    nvgSave(vg);
+    nvgBeginPath(vg);
+    nvgRoundedRect(vg, left, top, panelWidth, panelHeight, 8);
+    nvgFillColor(vg, nvgRGBA(0, 0, 0, 200));
+    nvgFill(vg);
+
+    nvgFontFaceId(vg, brls::Application::getFont(FONT_REGULAR));
+    nvgFontSize(vg, 16);
+    nvgTextAlign(vg, NVG_ALIGN_LEFT | NVG_ALIGN_TOP);
+    nvgFillColor(vg, nvgRGB(255, 255, 255));
+
+    char line[128];
+    float textX = left + 12;
+    top += 10;
+    auto text = [&](const char* value) {
+        nvgText(vg, textX, top, value, nullptr);
+        top += lineHeight;
+    };
+
+    snprintf(line, sizeof(line), "%zu frames   p50 %.1f   p95 %.1f   p99 %.1f   max %.1f ms", frames.size(),
+        percentile(0.50f), percentile(0.95f), percentile(0.99f), sorted.back());
+    text(line);
+    for (int phase = 0; phase < FrameProfiler::PhaseCount; phase++) {
+        snprintf(line, sizeof(line), "  %-8s avg %6.2f   max %6.2f ms", FrameProfiler::phaseName((FrameProfiler::Phase)phase),
+            phaseSum[phase] / frames.size(), phaseMax[phase]);
+        text(line);
+    }
+    if (profiler.getLastInputLatencyMs() >= 0) {
+        snprintf(line, sizeof(line), "Last input to screen: %.1f ms", profiler.getLastInputLatencyMs());
+    } else {
+        snprintf(line, sizeof(line), "Last input to screen: -");
+    }
+    text(line);
+
+    // Histogram: green fits a 60 fps frame, yellow 30 fps, red anything slower
+    int tallest = *std::max_element(buckets, buckets + BucketCount);
+    float barWidth = (panelWidth - 24) / BucketCount;
+    float barBottom = top + histogramHeight - lineHeight;
+    for (int bucket = 0; bucket < BucketCount; bucket++) {
+        float barHeight = tallest > 0 ? (histogramHeight - lineHeight - 4) * buckets[bucket] / tallest : 0;
+        float barX = textX + bucket * barWidth;
+        nvgBeginPath(vg);
+        nvgRect(vg, barX + 2, barBottom - barHeight, barWidth - 4, barHeight);
+        nvgFillColor(vg, BucketLimits[bucket] <= 16.7f ? nvgRGB(60, 200, 80) : BucketLimits[bucket] <= 33.3f ? nvgRGB(230, 190, 40) : nvgRGB(230, 60, 60));
+        nvgFill(vg);
+
+        nvgFillColor(vg, nvgRGB(200, 200, 200));
+        nvgText(vg, barX + 2, barBottom + 2, BucketLabels[bucket], nullptr);
+    }
+    top += histogramHeight;
+
+    nvgFillColor(vg, nvgRGB(255, 255, 255));
+    text("Worst frames");
+    for (size_t i = 0; i < worstCount; i++) {
+        const FrameProfiler::Frame* frame = worst[i];
+        int dominant = 0;
+        for (int phase = 1; phase < FrameProfiler::PhaseCount; phase++) {
+            if (phase != FrameProfiler::Idle && frame->phaseMs[phase] > frame->phaseMs[dominant]) dominant = phase;
+        }
+        snprintf(line, sizeof(line), "  #%llu  %.1f ms  (%s %.1f ms)", (unsigned long long)frame->index, frame->totalMs,
+            FrameProfiler::phaseName((FrameProfiler::Phase)dominant), frame->phaseMs[dominant]);
+        text(line);
+    }
+    nvgRestore(vg);
+}
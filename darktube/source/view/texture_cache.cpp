@@ -0,0 +1,73 @@
+#include <borealis/core/application.hpp>
+#include <borealis/core/logger.hpp>
+#include "view/texture_cache.hpp"
+
+void TextureCache::touch(Entry& entry) {
+    lru.splice(lru.begin(), lru, entry.lruPos);
+}
+
+int TextureCache::acquire(const std::string& url) {
+    auto it = entries.find(url);
+    if (it == entries.end()) {
+        misses++;
+        return -1;
+    }
+
+    hits++;
+    it->second.refs++;
+    touch(it->second);
+    return it->second.texture;
+}
+
+int TextureCache::insert(const std::string& url, const unsigned char* rgba, int width, int height) {
+    auto it = entries.find(url);
+    if (it != entries.end()) {
+        it->second.refs++;
+        touch(it->second);
+        return it->second.texture;
+    }
+
+    int texture = nvgCreateImageRGBA(brls::Application::getNVGContext(), width, height, 0, rgba);
+    if (texture <= 0) return -1;
+
+    lru.push_front(url);
+    Entry entry{texture, (size_t)width * height * 4, 1, lru.begin()};
+    entries.emplace(url, entry);
+    totalBytes += entry.bytes;
+
+    evict();
+    return texture;
+}
+
+void TextureCache::release(const std::string& url) {
+    auto it = entries.find(url);
+    if (it == entries.end()) return;
+
+    if (it->second.refs > 0) it->second.refs--;
+    if (it->second.refs == 0) evict();
+}
+
+void TextureCache::setMaxBytes(size_t bytes) {
+    maxBytes = bytes;
+    evict();
+}
+
+void TextureCache::evict() {
+    // Walk from the least recently used end; textures still on screen are skipped
+    auto pos = lru.end();
+    while (totalBytes > maxBytes && pos != lru.begin()) {
+        --pos;
+        auto it = entries.find(*pos);
+        if (it->second.refs > 0) continue;
+
+        nvgDeleteImage(brls::Application::getNVGContext(), it->second.texture);
+        totalBytes -= it->second.bytes;
+        entries.erase(it);
+        pos = lru.erase(pos);
+    }
+}
+
+void TextureCache::logStats() const {
+    brls::Logger::info("TextureCache: {} textures, {} KiB, {} hits, {} misses",
+        entries.size(), totalBytes / 1024, hits, misses);
+}
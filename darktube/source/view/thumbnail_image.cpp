@@ -0,0 +1,76 @@
+#include "view/thumbnail_image.hpp"
+#include "view/thumbnail_loader.hpp"
+#include "view/texture_cache.hpp"
+#include "../include/data/network_client.hpp"
+
+ThumbnailImage::~ThumbnailImage() {
+    *alive = false;
+    cancelLoad();
+    releaseTexture();
+}
+
+void ThumbnailImage::setThumbnailUrl(const std::string& newUrl) {
+    if (newUrl == url && (!url.empty() || showsPlaceholder)) return;
+
+    cancelLoad();
+    releaseTexture();
+    url = newUrl;
+    if (url.empty()) {
+        showPlaceholder();
+        return;
+    }
+
+    int texture = TextureCache::instance().acquire(url);
+    if (texture >= 0) {
+        showTexture(texture);
+        return;
+    }
+
+    loadToken = std::make_shared<DarkTube::Data::CancelToken>();
+    ThumbnailLoader::instance().load(this, url, alive, loadToken, loadPriority);
+}
+
+void ThumbnailImage::cancelLoad() {
+    if (!loadToken) return;
+
+    DarkTube::Data::NetworkClient::instance().cancel(loadToken);
+    loadToken = nullptr;
+    if (!holdsTexture) url.clear();
+}
+
+void ThumbnailImage::onThumbnailDecoded(const std::string& decodedUrl, const std::vector<unsigned char>& pixels) {
+    // The card moved on to another video meanwhile
+    if (decodedUrl != url || holdsTexture) return;
+    loadToken = nullptr;
+
+    if (pixels.empty()) {
+        showPlaceholder();
+        return;
+    }
+
+    int texture = TextureCache::instance().insert(url, pixels.data(), ThumbnailLoader::Width, ThumbnailLoader::Height);
+    if (texture >= 0) showTexture(texture);
+}
+
+void ThumbnailImage::showTexture(int texture) {
+    this->setImageFromTexture(texture);
+    this->setFreeTexture(false); // Owned by TextureCache
+    holdsTexture = true;
+    showsPlaceholder = false;
+}
+
+// For videos without a thumbnail and failed downloads; the texture is ours to free
+void ThumbnailImage::showPlaceholder() {
+    this->setImageFromFile("romfs:/img/video_placeholder.png");
+    this->setFreeTexture(true);
+    showsPlaceholder = true;
+}
+
+void ThumbnailImage::releaseTexture() {
+    if (!holdsTexture) return;
+
+    // Stop drawing it first, the cache may delete it once unreferenced
+    this->clear();
+    TextureCache::instance().release(url);
+    holdsTexture = false;
+}
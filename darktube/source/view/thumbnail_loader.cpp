@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <stb_image.h>
+#include <borealis/core/logger.hpp>
+#include "view/thumbnail_loader.hpp"
+#include "view/thumbnail_image.hpp"
+#include "view/frame_pacer.hpp"
+#include "../include/data/network_client.hpp"
+
+void ThumbnailLoader::load(ThumbnailImage* image, const std::string& url, std::shared_ptr<bool> alive, DarkTube::Data::CancelTokenPtr token,
+                           DarkTube::Data::PriorityFn priority) {
+    DarkTube::Data::NetworkClient::instance().fetchImage(url, [this, image, alive, url, token](const std::string& data) {
+        // Runs on a worker thread, `alive` is only checked on the main thread
+        if (token->isCancelled()) return;
+
+        DecodedThumbnail thumb{image, alive, url, {}};
+        if (!data.empty() && !decode(data, thumb.pixels)) {
+            brls::Logger::error("ThumbnailLoader: failed to decode image ({} bytes)", data.size());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(uploadMutex);
+            uploads.push_back(std::move(thumb));
+        }
+        FramePacer::instance().wake();
+    }, token, priority);
+}
+
+bool ThumbnailLoader::decode(const std::string& data, std::vector<unsigned char>& pixels) {
+    int w, h, channels;
+    unsigned char* src = stbi_load_from_memory((const unsigned char*)data.data(), (int)data.size(), &w, &h, &channels, 4);
+    if (!src) return false;
+
+    // Crop to the card aspect ratio (like FILL scaling), then area-average down to Width x Height
+    float scale = std::min((float)w / Width, (float)h / Height);
+    float cropX = (w - Width * scale) / 2.0f;
+    float cropY = (h - Height * scale) / 2.0f;
+
+    pixels.resize(Width * Height * 4);
+    for (int y = 0; y < Height; y++) {
+        int sy0 = std::min(h - 1, (int)(cropY + y * scale));
+        int sy1 = std::min(h, std::max(sy0 + 1, (int)(cropY + (y + 1) * scale)));
+        for (int x = 0; x < Width; x++) {
+            int sx0 = std::min(w - 1, (int)(cropX + x * scale));
+            int sx1 = std::min(w, std::max(sx0 + 1, (int)(cropX + (x + 1) * scale)));
+
+            unsigned int sum[4] = {0, 0, 0, 0};
+            for (int sy = sy0; sy < sy1; sy++) {
+                const unsigned char* p = src + (sy * w + sx0) * 4;
+                for (int sx = sx0; sx < sx1; sx++, p += 4) {
+                    sum[0] += p[0];
+                    sum[1] += p[1];
+                    sum[2] += p[2];
+                    sum[3] += p[3];
+                }
+            }
+
+            unsigned int count = (sy1 - sy0) * (sx1 - sx0);
+            unsigned char* out = pixels.data() + (y * Width + x) * 4;
+            for (int c = 0; c < 4; c++) out[c] = (unsigned char)(sum[c] / count);
+        }
+    }
+
+    stbi_image_free(src);
+    return true;
+}
+
+void ThumbnailLoader::processUploads() {
+    size_t uploaded = 0;
+    while (uploaded < maxUploadsPerFrame) {
+        DecodedThumbnail thumb;
+        {
+            std::lock_guard<std::mutex> lock(uploadMutex);
+            if (uploads.empty()) return;
+            thumb = std::move(uploads.front());
+            uploads.pop_front();
+        }
+
+        // The card was thrown away while we were decoding
+        if (!*thumb.alive) continue;
+
+        // Uploads into the shared TextureCache
+        thumb.image->onThumbnailDecoded(thumb.url, thumb.pixels);
+        uploaded++;
+    }
+}
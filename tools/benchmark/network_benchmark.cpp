@@ -0,0 +1,223 @@
+// Headless NetworkClient benchmark. Run it against tools/test-server (or a real
+// darktube-server) to get latency percentiles without a Switch or a UI:
+//
+//   darktube_netbench [base url] [iterations]
+//
+// Defaults to http://127.0.0.1:3000 and 50 iterations per scenario.
+
+#include "data/network_client.hpp"
+#include <borealis/core/logger.hpp>
+#include <borealis/core/thread.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace DarkTube;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+    constexpr int TimeoutMs = 30000;
+
+    struct Samples {
+        std::vector<double> latencyMs;
+        size_t errors = 0;
+        size_t items = 0;   // videos, images or streams delivered
+        size_t bytes = 0;
+        double wallMs = 0;
+    };
+
+    double elapsedMs(Clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+    }
+
+    // Nearest-rank percentile of sorted samples
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0;
+        size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+        return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    void report(const char* name, Samples& samples, const char* unit) {
+        std::sort(samples.latencyMs.begin(), samples.latencyMs.end());
+        double seconds = samples.wallMs / 1000.0;
+        double throughput = seconds > 0 ? samples.items / seconds : 0;
+        printf("%-20s n=%-4zu err=%-3zu p50=%7.1f  p95=%7.1f  p99=%7.1f  max=%7.1f ms  %8.1f %s/s",
+            name, samples.latencyMs.size(), samples.errors,
+            percentile(samples.latencyMs, 50), percentile(samples.latencyMs, 95), percentile(samples.latencyMs, 99),
+            samples.latencyMs.empty() ? 0.0 : samples.latencyMs.back(), throughput, unit);
+        if (samples.bytes > 0) printf("  %8.1f KiB/s", seconds > 0 ? samples.bytes / 1024.0 / seconds : 0);
+        printf("\n");
+    }
+
+    // NetworkClient hands results to the main thread through brls::sync; this is
+    // the benchmark's main loop
+    bool waitFor(const std::atomic<bool>& done) {
+        auto start = Clock::now();
+        while (!done) {
+            brls::Threading::performSyncTasks();
+            if (elapsedMs(start) > TimeoutMs) return false;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        return true;
+    }
+
+    // One page at a time, like scrolling to the end of the grid
+    Samples benchPages(bool search, int iterations, std::vector<std::string>* thumbnails) {
+        Samples samples;
+        auto wall = Clock::now();
+        for (int i = 0; i < iterations; i++) {
+            // Shared with the callback, which may still arrive after a timeout
+            struct Result {
+                std::atomic<bool> done{false};
+                std::vector<Domain::VideoRef> videos;
+                std::string error;
+            };
+            auto result = std::make_shared<Result>();
+            auto start = Clock::now();
+
+            auto cb = [result](const std::vector<Domain::VideoRef>& videos, const std::string& nextPageToken, const std::string& error) {
+                result->videos = videos;
+                result->error = error;
+                result->done = true;
+            };
+            std::string token = i == 0 ? "" : std::to_string(i);
+            if (search) {
+                Data::NetworkClient::instance().search("benchmark", cb, token);
+            } else {
+                Data::NetworkClient::instance().getTrending(cb, token);
+            }
+
+            // An error payload parses as an empty page
+            if (!waitFor(result->done) || !result->error.empty() || result->videos.empty()) {
+                samples.errors++;
+                continue;
+            }
+            samples.latencyMs.push_back(elapsedMs(start));
+            samples.items += result->videos.size();
+            if (thumbnails && thumbnails->empty()) {
+                for (auto& video : result->videos) thumbnails->emplace_back(video->thumbnailUrlMedium);
+            }
+        }
+        samples.wallMs = elapsedMs(wall);
+        return samples;
+    }
+
+    // A full grid's worth of thumbnails requested at once, like a freshly shown page.
+    // `each` gets per-image latencies, the result the time until the last one arrived.
+    Samples benchThumbnails(const std::vector<std::string>& urls, int iterations, Samples& each) {
+        Samples samples;
+        auto wall = Clock::now();
+        for (int i = 0; i < iterations; i++) {
+            struct Result {
+                explicit Result(size_t count) : remaining(count), latencies(count) {}
+                std::atomic<size_t> remaining;
+                std::atomic<bool> done{false};
+                std::atomic<size_t> failed{0};
+                std::atomic<size_t> bytes{0};
+                std::vector<double> latencies; // one slot per image, so no lock is needed
+            };
+            auto result = std::make_shared<Result>(urls.size());
+            auto start = Clock::now();
+
+            for (size_t u = 0; u < urls.size(); u++) {
+                // A distinct query per iteration, so nothing is joined with an earlier request
+                std::string url = urls[u] + "?i=" + std::to_string(i);
+                Data::NetworkClient::instance().fetchImage(url, [result, u, start](const std::string& data) {
+                    result->latencies[u] = elapsedMs(start);
+                    if (data.empty()) result->failed++;
+                    result->bytes += data.size();
+                    if (--result->remaining == 0) result->done = true;
+                });
+            }
+
+            bool finished = waitFor(result->done);
+            size_t failed = result->failed;
+            if (!finished || failed > 0) samples.errors++;
+            if (!finished) continue;
+            samples.latencyMs.push_back(elapsedMs(start));
+            samples.items += urls.size() - failed;
+            samples.bytes += result->bytes;
+            each.latencyMs.insert(each.latencyMs.end(), result->latencies.begin(), result->latencies.end());
+            each.errors += failed;
+            each.items += urls.size() - failed;
+            each.bytes += result->bytes;
+        }
+        samples.wallMs = each.wallMs = elapsedMs(wall);
+        return samples;
+    }
+
+    // Play pressed on a video that was never prefetched
+    Samples benchStreams(int iterations) {
+        Samples samples;
+        auto wall = Clock::now();
+        for (int i = 0; i < iterations; i++) {
+            struct Result {
+                std::atomic<bool> done{false};
+                std::string error;
+            };
+            auto result = std::make_shared<Result>();
+            auto start = Clock::now();
+
+            // Unique ids, so StreamCache never answers
+            Data::NetworkClient::instance().getStream("bench" + std::to_string(i), [result](const Domain::StreamInfo& info, const std::string& error) {
+                result->error = error;
+                result->done = true;
+            });
+
+            if (!waitFor(result->done) || !result->error.empty()) {
+                samples.errors++;
+                continue;
+            }
+            samples.latencyMs.push_back(elapsedMs(start));
+            samples.items++;
+        }
+        samples.wallMs = elapsedMs(wall);
+        return samples;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string baseUrl = argc > 1 ? argv[1] : "http://127.0.0.1:3000";
+    int iterations = argc > 2 ? std::max(1, atoi(argv[2])) : 50;
+
+    brls::Logger::setLogLevel(brls::LogLevel::LOG_WARNING);
+    brls::Threading::start();
+
+    // Not saved: a benchmark run must not replace the active server in darktube_config.json
+    Data::NetworkClient::instance().setBaseUrlOverride(baseUrl);
+    printf("DarkTube network benchmark: %s, %d iterations\n\n", baseUrl.c_str(), iterations);
+
+    std::vector<std::string> thumbnails;
+    Samples trending = benchPages(false, iterations, &thumbnails);
+    report("trending page", trending, "videos");
+    Samples search = benchPages(true, iterations, nullptr);
+    report("search page", search, "videos");
+
+    if (thumbnails.empty()) {
+        printf("%-20s skipped: no thumbnail URLs in the first trending page\n", "thumbnails");
+    } else {
+        Samples each;
+        Samples grid = benchThumbnails(thumbnails, iterations, each);
+        report("thumbnail page", grid, "images");
+        report("thumbnail (each)", each, "images");
+    }
+
+    Samples streams = benchStreams(iterations);
+    report("stream resolution", streams, "streams");
+
+    Data::HttpReactor::Stats stats = Data::NetworkClient::instance().getTransferStats();
+    printf("\n%zu transfers over %zu connections (%zu over HTTP/2), %.1f KiB received for %.1f KiB of content\n",
+        stats.transfers, stats.connections, stats.http2Transfers, stats.wireBytes / 1024.0, stats.bodyBytes / 1024.0);
+
+    brls::Threading::stop();
+    return trending.errors + search.errors + streams.errors > 0 ? 1 : 0;
+}
@@ -0,0 +1,208 @@
+// Parsing microbenchmark: runs the response parsers NetworkClient uses (FeedParser,
+// StreamInfoParser) over the fixtures in tools/test-server/fixtures.
+//
+//   darktube_parsebench [fixtures dir]
+//
+// Bodies are fed in 16 KiB chunks, the most curl hands to a write callback at once.
+// Allocations and peak memory are counted by replacing the global operator new, so
+// the benchmark is single-threaded.
+
+#include "data/response_parsers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+
+#ifndef DARKTUBE_FIXTURES_DIR
+#define DARKTUBE_FIXTURES_DIR "tools/test-server/fixtures"
+#endif
+
+// --- Allocation counting ---
+
+namespace {
+
+    constexpr size_t Header = alignof(std::max_align_t); // keeps the block's size in front of it
+
+    size_t allocCount = 0;
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;
+
+} // namespace
+
+void* operator new(size_t size) {
+    char* block = (char*)malloc(size + Header);
+    if (!block) throw std::bad_alloc();
+    *(size_t*)block = size;
+    allocCount++;
+    liveBytes += size;
+    peakBytes = std::max(peakBytes, liveBytes);
+    return block + Header;
+}
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    char* block = (char*)p - Header;
+    liveBytes -= *(size_t*)block;
+    free(block);
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+// --- Benchmark ---
+
+using namespace DarkTube;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+    constexpr size_t ChunkSize = 16 * 1024;
+    constexpr double MinSeconds = 0.5; // per fixture, after warming up
+
+    // Fills the test server's placeholders the way it would
+    std::string loadFixture(const std::string& dir, const std::string& name) {
+        std::ifstream file(dir + "/" + name, std::ios::binary);
+        if (!file) return "";
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        std::string body = buffer.str();
+
+        const std::pair<const char*, const char*> values[] = {
+            {"{{base}}", "http://192.168.1.10:3000"}, {"{{page}}", "00"}, {"{{next}}", "1"}, {"{{id}}", "dQw4w9WgXcQ"}};
+        for (auto& value : values) {
+            std::string placeholder = value.first;
+            for (size_t at = body.find(placeholder); at != std::string::npos; at = body.find(placeholder, at)) {
+                body.replace(at, placeholder.size(), value.second);
+                at += strlen(value.second);
+            }
+        }
+        return body;
+    }
+
+    struct Result {
+        size_t items = 0;
+        size_t runs = 0;
+        double ns = 0;
+        size_t allocs = 0;
+        size_t peak = 0; // most bytes live at once above what was live before the run
+        std::string error;
+    };
+
+    void feed(Data::JsonBodyParser& parser, const std::string& body) {
+        for (size_t offset = 0; offset < body.size(); offset += ChunkSize) {
+            if (!parser.write(body.data() + offset, std::min(ChunkSize, body.size() - offset))) break;
+        }
+    }
+
+    // `parse` returns the number of items it produced, or 0 on failure
+    template <typename Parse>
+    Result run(const std::string& body, Parse parse) {
+        Result result;
+        for (int i = 0; i < 10; i++) parse(body, result.error); // warm up caches and the allocator
+
+        auto wall = Clock::now();
+        while (std::chrono::duration<double>(Clock::now() - wall).count() < MinSeconds) {
+            size_t allocsBefore = allocCount;
+            size_t liveBefore = liveBytes;
+            peakBytes = liveBytes;
+
+            auto start = Clock::now();
+            size_t items = parse(body, result.error);
+            result.ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+            if (items == 0) return result;
+            result.items = items;
+            result.allocs += allocCount - allocsBefore;
+            result.peak = std::max(result.peak, peakBytes - liveBefore);
+            result.runs++;
+        }
+        return result;
+    }
+
+    size_t parseFeed(Data::FeedParser::Kind kind, const std::string& body, std::string& error) {
+        Data::FeedParser parser(kind);
+        feed(parser, body);
+        if (!parser.finish()) {
+            error = parser.getError();
+            return 0;
+        }
+        return parser.videos.size();
+    }
+
+    size_t parseStream(const std::string& body, std::string& error) {
+        Data::StreamInfoParser parser;
+        feed(parser, body);
+        if (!parser.finish()) {
+            error = parser.getError();
+            return 0;
+        }
+        return parser.info.formats.size();
+    }
+
+    void report(const char* name, const std::string& body, const Result& result, const char* unit) {
+        if (result.runs == 0) {
+            printf("%-26s failed: %s\n", name, result.error.empty() ? "no items" : result.error.c_str());
+            return;
+        }
+        double nsPerRun = result.ns / result.runs;
+        printf("%-26s %8.1f %5zu %-7s %9.0f %11.1f %10.1f %8.1f\n",
+            name, body.size() / 1024.0, result.items, unit,
+            nsPerRun / result.items,
+            (double)result.allocs / result.runs / result.items,
+            result.peak / 1024.0,
+            body.size() / (nsPerRun / 1e9) / (1024.0 * 1024.0));
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string dir = argc > 1 ? argv[1] : DARKTUBE_FIXTURES_DIR;
+
+    struct Feed {
+        const char* file;
+        Data::FeedParser::Kind kind;
+    };
+    const Feed feeds[] = {
+        {"trending.json", Data::FeedParser::Kind::Trending},
+        {"trending_50.json", Data::FeedParser::Kind::Trending},
+        {"search.json", Data::FeedParser::Kind::Search},
+    };
+    const char* streams[] = {"stream.json", "stream_many_formats.json"};
+
+    printf("DarkTube parse benchmark: %s, %zu KiB chunks\n\n", dir.c_str(), ChunkSize / 1024);
+    printf("%-26s %8s %13s %9s %11s %10s %8s\n", "fixture", "KiB", "items", "ns/item", "allocs/item", "peak KiB", "MiB/s");
+
+    bool ok = true;
+    for (const Feed& entry : feeds) {
+        std::string body = loadFixture(dir, entry.file);
+        if (body.empty()) {
+            printf("%-26s missing\n", entry.file);
+            ok = false;
+            continue;
+        }
+        Data::FeedParser::Kind kind = entry.kind;
+        Result result = run(body, [kind](const std::string& b, std::string& error) { return parseFeed(kind, b, error); });
+        report(entry.file, body, result, "videos");
+        ok = ok && result.runs > 0;
+    }
+    for (const char* file : streams) {
+        std::string body = loadFixture(dir, file);
+        if (body.empty()) {
+            printf("%-26s missing\n", file);
+            ok = false;
+            continue;
+        }
+        Result result = run(body, parseStream);
+        report(file, body, result, "formats");
+        ok = ok && result.runs > 0;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+#!/bin/bash
+# Replays one home screen load (a trending page, its 20 thumbnails and a stream
+# lookup, all in parallel like the client issues them) twice against a running
+# start.sh: the old way (HTTP/1.1, no Accept-Encoding) and the new way (HTTP/2 over
+# TLS, Accept-Encoding). Prints the server's connection and byte counts for each.
+HOST=${HOST:-localhost}
+HTTP_PORT=${HTTP_PORT:-3000}
+HTTPS_PORT=${HTTPS_PORT:-3443}
+
+urls() {
+    echo "$1/api/trending?maxResults=20"
+    echo "$1/api/stream?id=vid00000000"
+    for i in $(seq 0 19); do
+        printf "%s/thumb/00vid%06d/mqdefault.jpg\n" "$1" "$i"
+    done
+}
+
+run() {
+    local base=$1; shift
+    local args=()
+    for url in $(urls "$base"); do args+=(-o /dev/null "$url"); done
+    curl -s -k "http://$HOST:$HTTP_PORT/_stats?reset=1" > /dev/null
+    curl -s --no-progress-meter -k --parallel --parallel-max 16 "$@" "${args[@]}"
+    curl -s "http://$HOST:$HTTP_PORT/_stats?reset=1"
+}
+
+echo "== HTTP/1.1, uncompressed =="
+run "http://$HOST:$HTTP_PORT" --http1.1
+echo "== HTTP/2, compressed =="
+run "https://$HOST:$HTTPS_PORT" --http2 --compressed
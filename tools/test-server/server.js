@@ -0,0 +1,177 @@
+// Local stand-in for darktube-server, used to check what the client puts on the wire
+// and to benchmark it (see tools/benchmark).
+//
+//   https://<host>:3443  HTTP/2 (HTTP/1.1 for clients that don't offer h2 via ALPN)
+//   http://<host>:3000   HTTP/1.1 only, like a stock darktube-server
+//
+// Both ports serve the payloads in fixtures/ and compress JSON with br or gzip when the
+// client asks for it. GET /_stats returns connections, requests and body bytes (sent,
+// and before compression) per port and protocol; GET /_stats?reset=1 zeroes them.
+//
+// Network conditions, all optional:
+//   LATENCY_MS      delay before each response starts
+//   JITTER_MS       up to this much extra delay, uniformly distributed
+//   BANDWIDTH_KBPS  per-response cap on how fast the body is sent
+//   ERROR_RATE      share of requests (0..1) answered with a 500 and an error payload
+//   DROP_RATE       share of requests (0..1) whose connection dies halfway through the body
+
+const fs = require('fs');
+const http = require('http');
+const http2 = require('http2');
+const path = require('path');
+const zlib = require('zlib');
+
+const dir = __dirname;
+const HTTPS_PORT = Number(process.env.HTTPS_PORT || 3443);
+const HTTP_PORT = Number(process.env.HTTP_PORT || 3000);
+const LATENCY_MS = Number(process.env.LATENCY_MS || 0);
+const JITTER_MS = Number(process.env.JITTER_MS || 0);
+const BANDWIDTH_KBPS = Number(process.env.BANDWIDTH_KBPS || 0);
+const ERROR_RATE = Number(process.env.ERROR_RATE || 0);
+const DROP_RATE = Number(process.env.DROP_RATE || 0);
+
+let stats;
+function resetStats() {
+    stats = {};
+}
+function bucket(port, protocol) {
+    const key = `${port} ${protocol}`;
+    if (!stats[key]) {
+        stats[key] = { connections: 0, requests: 0, errors: 0, drops: 0, wireBytes: 0, contentBytes: 0, jsonWireBytes: 0, jsonContentBytes: 0 };
+    }
+    return stats[key];
+}
+resetStats();
+
+// --- Fixtures ---
+
+// Placeholders: {{base}} is this server, {{page}} the page token, {{next}} the next
+// one and {{id}} the requested video
+function fixture(name) {
+    return fs.readFileSync(path.join(dir, 'fixtures', name), 'utf8');
+}
+const fixtures = {
+    trending: fixture('trending.json'),
+    search: fixture('search.json'),
+    stream: fixture('stream.json'),
+};
+
+function fill(template, values) {
+    return Buffer.from(template.replace(/\{\{(\w+)\}\}/g, (match, key) => (key in values ? values[key] : match)));
+}
+
+// A real 320x180 JPEG (~12 KiB) so the app's decoder runs its normal path
+const thumbnail = fs.readFileSync(path.join(dir, 'fixtures', 'thumbnail.jpg'));
+
+// --- Serving ---
+
+function negotiate(acceptEncoding) {
+    const accepted = String(acceptEncoding || '').split(',').map((e) => e.trim().split(';')[0]);
+    if (accepted.includes('br')) return 'br';
+    if (accepted.includes('gzip')) return 'gzip';
+    return null;
+}
+
+// Paces the body in 50 ms slices when a bandwidth cap is set
+function writeBody(res, body, drop) {
+    const end = drop ? Math.floor(body.length / 2) : body.length;
+    const finish = () => (drop ? (res.stream ? res.stream.close(http2.constants.NGHTTP2_INTERNAL_ERROR) : res.socket.destroy()) : res.end());
+
+    if (!BANDWIDTH_KBPS) {
+        res.write(body.subarray(0, end));
+        return finish();
+    }
+    const bytesPerMs = (BANDWIDTH_KBPS * 1024) / 1000;
+    const slice = Math.max(1, Math.floor(bytesPerMs * 50));
+    let offset = 0;
+    // Each slice goes out once the time it would take on the wire has passed
+    const next = () => {
+        if (res.destroyed) return;
+        if (offset >= end) return finish();
+        const chunk = body.subarray(offset, Math.min(offset + slice, end));
+        offset += chunk.length;
+        setTimeout(() => {
+            res.write(chunk);
+            next();
+        }, chunk.length / bytesPerMs);
+    };
+    next();
+}
+
+function send(req, res, port, protocol, status, type, content) {
+    const b = bucket(port, protocol);
+    b.requests++;
+
+    if (Math.random() < ERROR_RATE) {
+        status = 500;
+        type = 'application/json';
+        content = Buffer.from('{"error":"Injected failure"}');
+        b.errors++;
+    }
+    const drop = Math.random() < DROP_RATE;
+    if (drop) b.drops++;
+
+    let body = content;
+    const headers = { 'content-type': type, vary: 'accept-encoding' };
+    const encoding = type.startsWith('application/json') ? negotiate(req.headers['accept-encoding']) : null;
+    if (encoding === 'br') body = zlib.brotliCompressSync(content, { params: { [zlib.constants.BROTLI_PARAM_QUALITY]: 5 } });
+    if (encoding === 'gzip') body = zlib.gzipSync(content, { level: 6 });
+    if (encoding) headers['content-encoding'] = encoding;
+    headers['content-length'] = body.length;
+
+    b.wireBytes += req.method === 'HEAD' ? 0 : body.length;
+    b.contentBytes += req.method === 'HEAD' ? 0 : content.length;
+    if (type.startsWith('application/json')) {
+        b.jsonWireBytes += body.length;
+        b.jsonContentBytes += content.length;
+    }
+
+    setTimeout(() => {
+        res.writeHead(status, headers);
+        if (req.method === 'HEAD') return res.end();
+        writeBody(res, body, drop);
+    }, LATENCY_MS + Math.random() * JITTER_MS);
+}
+
+function handle(port, req, res) {
+    const protocol = req.httpVersion === '2.0' ? 'h2' : 'http/1.1';
+    const scheme = port === HTTPS_PORT ? 'https' : 'http';
+    const base = `${scheme}://${req.headers[':authority'] || req.headers.host}`;
+    const url = new URL(req.url, base);
+    const json = (template, values) => send(req, res, port, protocol, 200, 'application/json; charset=utf-8', fill(template, values));
+
+    if (url.pathname === '/_stats') {
+        const snapshot = stats;
+        if (url.searchParams.has('reset')) resetStats();
+        res.writeHead(200, { 'content-type': 'application/json' });
+        return res.end(JSON.stringify(snapshot, null, 2) + '\n');
+    }
+
+    // Counted on first use, so the connection that fetches /_stats doesn't show up
+    const connection = req.stream ? req.stream.session : req.socket;
+    if (!connection.darktubeCounted) {
+        connection.darktubeCounted = true;
+        bucket(port, protocol).connections++;
+    }
+
+    const page = Number(url.searchParams.get('pageToken') || 0);
+    const pageValues = { base, page: String(page).padStart(2, '0'), next: String(page + 1) };
+    if (url.pathname === '/api/trending') return json(fixtures.trending, pageValues);
+    if (url.pathname === '/api/search') return json(fixtures.search, pageValues);
+    if (url.pathname === '/api/stream') return json(fixtures.stream, { base, id: url.searchParams.get('id') || 'unknown' });
+    if (url.pathname.startsWith('/thumb/')) return send(req, res, port, protocol, 200, 'image/jpeg', thumbnail);
+    if (url.pathname === '/') return send(req, res, port, protocol, 200, 'text/plain', Buffer.from('darktube test server\n'));
+    send(req, res, port, protocol, 404, 'application/json', Buffer.from('{"error":"Not found"}'));
+}
+
+const secure = http2.createSecureServer({
+    key: fs.readFileSync(path.join(dir, 'key.pem')),
+    cert: fs.readFileSync(path.join(dir, 'cert.pem')),
+    allowHTTP1: true,
+}, (req, res) => handle(HTTPS_PORT, req, res));
+secure.listen(HTTPS_PORT);
+
+const plain = http.createServer((req, res) => handle(HTTP_PORT, req, res));
+plain.listen(HTTP_PORT);
+
+console.log(`darktube test server: https://localhost:${HTTPS_PORT} (h2, http/1.1), http://localhost:${HTTP_PORT} (http/1.1)`);
@@ -0,0 +1,11 @@
+#!/bin/bash
+# Starts the local test server, creating a self-signed certificate on first run
+# (the client doesn't verify certificates)
+cd "$(dirname "$0")"
+
+if [ ! -f key.pem ] || [ ! -f cert.pem ]; then
+    openssl req -x509 -newkey rsa:2048 -nodes -days 365 -subj "/CN=darktube-test" \
+        -keyout key.pem -out cert.pem 2>/dev/null || exit 1
+fi
+
+exec node server.js